@@ -0,0 +1,165 @@
+
+#include <bits/stdc++.h>
+#include <sys/resource.h>
+#include "scheduler_parser.h"
+#include "scheduler_algorithms.h"
+#include "workload_generator.h"
+
+using namespace std;
+
+/** Scaling benchmark: times every algorithm on seeded synthetic workloads of growing size **/
+
+struct BenchmarkOptions {
+    vector<int> sizes = {1000, 10000, 100000, 1000000};
+    string algorithms = "1,2-4,3,4,5,6,7,8-4,9-4,10-4,11-4";
+    WorkloadShape shape;
+    uint64_t seed = 1;
+    long long horizon = 0; // lastMoment of every workload, 0 for long enough to finish every process
+    int repetitions = 3;
+    string format = "csv"; // "csv" or "json"
+};
+
+struct BenchmarkResult {
+    string algorithm;
+    int processes;
+    int horizon;
+    long long events;       // Arrivals before the horizon plus dispatches
+    double seconds;         // Fastest of the repetitions
+    double nsPerEvent;
+    long peakRssKb;
+    double scalingExponent; // Slope of log(time) over log(size) from the previous size, NaN for the first
+};
+
+[[noreturn]] void usage() {
+    cerr << "Usage: benchmark [--sizes 1000,10000,...] [--algorithms 1,2-4,...] [--arrivals poisson|bursty]" << endl
+         << "                 [--service exponential|pareto] [--mean-service X] [--load X] [--seed N]" << endl
+         << "                 [--horizon T] [--repeat N] [--format csv|json]" << endl;
+    exit(1);
+}
+
+BenchmarkOptions parseOptions(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        string flag = argv[i];
+        if (i + 1 >= argc) usage();
+        string value = argv[++i];
+        if (flag == "--sizes") {
+            options.sizes.clear();
+            stringstream sizeStream(value);
+            string size;
+            while (getline(sizeStream, size, ',')) options.sizes.push_back((int)stod(size));
+        } else if (flag == "--algorithms") {
+            options.algorithms = value;
+        } else if (flag == "--arrivals") {
+            options.shape.arrivals = value;
+        } else if (flag == "--service") {
+            options.shape.service = value;
+        } else if (flag == "--mean-service") {
+            options.shape.meanService = stod(value);
+        } else if (flag == "--load") {
+            options.shape.loadFactor = stod(value);
+        } else if (flag == "--seed") {
+            options.seed = stoull(value);
+        } else if (flag == "--horizon") {
+            options.horizon = max(0LL, (long long)stod(value));
+        } else if (flag == "--repeat") {
+            options.repetitions = max(1, stoi(value));
+        } else if (flag == "--format") {
+            options.format = value;
+        } else {
+            usage();
+        }
+    }
+    if ((options.shape.arrivals != "poisson" && options.shape.arrivals != "bursty") ||
+        (options.shape.service != "exponential" && options.shape.service != "pareto") ||
+        (options.format != "csv" && options.format != "json")) {
+        usage();
+    }
+    return options;
+}
+
+long peakResidentKb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+BenchmarkResult measure(const Workload& workload, const pair<char, int>& algorithm, int repetitions) {
+    BenchmarkResult result{algorithmName(algorithm), workload.processCount, workload.lastMoment, 0, DBL_MAX, 0, 0, NAN};
+    SchedulerArena arena; // Repetitions after the first run on warm scheduler storage
+    for (int r = 0; r < repetitions; ++r) {
+        SimulationContext context(workload);
+        context.arena = &arena;
+        auto start = chrono::steady_clock::now();
+        executeSchedulingAlgorithm(context, algorithm.first, algorithm.second);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        result.seconds = min(result.seconds, elapsed.count());
+    }
+
+    // Counted on an extra run so the timed ones stay uninstrumented; run segments would undercount
+    // dispatches, because back-to-back slices of one process are merged
+    RunCounters counters;
+    SimulationContext context(workload, false);
+    context.arena = &arena;
+    context.counters = &counters;
+    executeSchedulingAlgorithm(context, algorithm.first, algorithm.second);
+    result.events = (lower_bound(workload.arrival.begin(), workload.arrival.end(), workload.lastMoment) - workload.arrival.begin()) + counters.dispatches;
+    result.nsPerEvent = result.seconds * 1e9 / max(1LL, result.events);
+    result.peakRssKb = peakResidentKb();
+    return result;
+}
+
+void printCsv(const vector<BenchmarkResult>& results) {
+    printf("algorithm,processes,horizon,events,seconds,ns_per_event,peak_rss_kb,scaling_exponent\n");
+    for (const BenchmarkResult& r : results) {
+        printf("%s,%d,%d,%lld,%.6f,%.2f,%ld,", r.algorithm.c_str(), r.processes, r.horizon, r.events, r.seconds, r.nsPerEvent, r.peakRssKb);
+        if (!isnan(r.scalingExponent)) printf("%.3f", r.scalingExponent);
+        printf("\n");
+    }
+}
+
+void printJson(const BenchmarkOptions& options, const vector<BenchmarkResult>& results) {
+    const WorkloadShape& shape = options.shape;
+    printf("{\n  \"workload\": {\"arrivals\": \"%s\", \"service\": \"%s\", \"mean_service\": %g, \"load\": %g, \"seed\": %llu},\n",
+           shape.arrivals.c_str(), shape.service.c_str(), shape.meanService, shape.loadFactor, (unsigned long long)options.seed);
+    printf("  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        printf("    {\"algorithm\": \"%s\", \"processes\": %d, \"horizon\": %d, \"events\": %lld, \"seconds\": %.6f, "
+               "\"ns_per_event\": %.2f, \"peak_rss_kb\": %ld, \"scaling_exponent\": ",
+               r.algorithm.c_str(), r.processes, r.horizon, r.events, r.seconds, r.nsPerEvent, r.peakRssKb);
+        if (isnan(r.scalingExponent)) printf("null"); else printf("%.3f", r.scalingExponent);
+        printf("}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options = parseOptions(argc, argv);
+    vector<pair<char, int>> schedulingAlgorithms = parseAlgorithms(options.algorithms);
+    sort(options.sizes.begin(), options.sizes.end());
+
+    // Sizes grow in the outer loop, so peak RSS is the high-water mark up to that size
+    vector<BenchmarkResult> results;
+    map<string, size_t> previousSize; // Algorithm label to its result at the previous size
+    for (int size : options.sizes) {
+        Workload workload = generateWorkload(size, options.shape, options.seed);
+        if (options.horizon > 0) workload.lastMoment = (int)min<long long>(options.horizon, INT_MAX - 1);
+        size_t firstOfSize = results.size();
+        for (const pair<char, int>& algorithm : schedulingAlgorithms) {
+            results.push_back(measure(workload, algorithm, options.repetitions));
+        }
+        for (size_t i = firstOfSize; i < results.size(); ++i) {
+            BenchmarkResult& result = results[i];
+            if (previousSize.count(result.algorithm)) {
+                const BenchmarkResult& previous = results[previousSize[result.algorithm]];
+                result.scalingExponent = log(result.seconds / previous.seconds) / log(1.0 * result.processes / previous.processes);
+            }
+        }
+        for (size_t i = firstOfSize; i < results.size(); ++i) previousSize[results[i].algorithm] = i;
+    }
+
+    if (options.format == "json") printJson(options, results);
+    else printCsv(results);
+    return 0;
+}
@@ -0,0 +1,359 @@
+#include <bits/stdc++.h>
+#include "scheduler_simulation.h"
+#include "scheduler_chrome_trace.h"
+#include "scheduler_montecarlo.h"
+#include "workload_generator.h"
+
+using namespace std;
+
+/** Randomized checks of the simulator and its file formats, run by run_tests.sh (also under ThreadSanitizer) **/
+
+mt19937 checkRandom(7);
+
+int randomBetween(int low, int high) {
+    return uniform_int_distribution<int>(low, high)(checkRandom);
+}
+
+// Small workload with clustered arrivals and a horizon that lets every process finish
+Workload randomWorkload(int processCount) {
+    Workload workload;
+    int time = 0;
+    long long totalService = 0;
+    for (int i = 0; i < processCount; ++i) {
+        time += randomBetween(0, 4);
+        workload.addProcess("P" + to_string(i), time, randomBetween(1, 12));
+        totalService += workload.service.back();
+    }
+    workload.processCount = processCount;
+    workload.lastMoment = time + totalService;
+    return workload;
+}
+
+// Workload of the given processes as name, arrival and service, with the given horizon
+Workload fixedWorkload(int lastMoment, const vector<tuple<string, int, int>>& processes) {
+    Workload workload;
+    for (const auto& [name, arrival, service] : processes) workload.addProcess(name, arrival, service);
+    workload.processCount = processes.size();
+    workload.lastMoment = lastMoment;
+    return workload;
+}
+
+bool sameResult(const SimulationResult& a, const SimulationResult& b) {
+    if (a.completionTime != b.completionTime || a.turnaroundTime != b.turnaroundTime) return false;
+    if (a.executionSegments.size() != b.executionSegments.size()) return false;
+    for (size_t i = 0; i < a.executionSegments.size(); ++i) {
+        if (a.executionSegments[i].size() != b.executionSegments[i].size()) return false;
+        for (size_t j = 0; j < a.executionSegments[i].size(); ++j) {
+            if (a.executionSegments[i][j].start != b.executionSegments[i][j].start ||
+                a.executionSegments[i][j].end != b.executionSegments[i][j].end) return false;
+        }
+    }
+    return true;
+}
+
+// Spec of an algorithm as numbered in the input format
+AlgorithmSpec algorithmSpec(int id, int quantum = -1, int cores = 1) {
+    AlgorithmSpec spec;
+    spec.id = id;
+    spec.quantum = quantum;
+    spec.cores = cores;
+    return spec;
+}
+
+AlgorithmSpec randomSpec() {
+    int id = randomBetween(1, 8);
+    AlgorithmSpec spec = algorithmSpec(id, requiresQuantum('0' + id) ? randomBetween(1, 5) : -1);
+    if ((spec.id == 6 || spec.id == 7) && randomBetween(0, 1)) {
+        spec.feedback.levelCount = randomBetween(0, 4);
+        if (randomBetween(0, 1)) spec.feedback.quanta = {1, 2, 3};
+        spec.feedback.boostPeriod = randomBetween(0, 1) ? randomBetween(1, 15) : 0;
+    }
+    return spec;
+}
+
+// A run resumed from a snapshot after editing the workload equals a full run over the edited workload
+int checkSnapshotResume() {
+    int failures = 0;
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        Workload workload = randomWorkload(randomBetween(1, 40));
+        AlgorithmSpec spec = randomSpec();
+        bool recordTimeline = randomBetween(0, 1);
+        vector<long long> snapshotTimes;
+        for (int k = randomBetween(0, 8); k > 0; --k) snapshotTimes.push_back(randomBetween(0, workload.lastMoment));
+
+        Simulation original(workload);
+        vector<SimulationSnapshot> snapshots;
+        SimulationResult full = original.run(spec, recordTimeline, snapshotTimes, snapshots);
+        failures += !sameResult(full, original.run(spec, recordTimeline));
+
+        Workload edited = workload;
+        switch (randomBetween(0, 2))
+        {
+        case 0: // Jobs appended to the tail
+            for (int k = randomBetween(1, 4); k > 0; --k) {
+                edited.addProcess("N" + to_string(k), edited.arrival.back() + randomBetween(0, 6), randomBetween(1, 10));
+                edited.processCount++;
+                edited.lastMoment += edited.service.back() + 6;
+            }
+            break;
+        case 1: // One job changed
+            edited.service[randomBetween(0, edited.processCount - 1)] = randomBetween(1, 12);
+            break;
+        default: // Horizon moved
+            edited.lastMoment = randomBetween(1, workload.lastMoment + 10);
+        }
+
+        Simulation editedSimulation(edited);
+        const SimulationSnapshot* from = editedSimulation.latestSnapshot(snapshots);
+        if (!from) continue;
+        vector<SimulationSnapshot> moreSnapshots;
+        SimulationResult resumed = editedSimulation.resume(*from, recordTimeline, snapshotTimes, moreSnapshots);
+        failures += !sameResult(resumed, editedSimulation.run(spec, recordTimeline));
+    }
+    return failures;
+}
+
+// Many threads running one Simulation at once get the results of sequential runs
+int checkConcurrentRuns() {
+    Simulation simulation(generateWorkload(2000, WorkloadShape(), 7));
+    vector<AlgorithmSpec> specs;
+    for (int id = 1; id <= ALGORITHM_COUNT; ++id) specs.push_back(algorithmSpec(id, requiresQuantum('0' + id) ? 3 : -1));
+    specs.push_back(algorithmSpec(2, 4, 4));
+    specs.push_back(algorithmSpec(7, -1, 8));
+    vector<SimulationResult> sequential;
+    for (const AlgorithmSpec& spec : specs) sequential.push_back(simulation.run(spec, true));
+
+    atomic<int> failures(0);
+    vector<thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int k = 0; k < 10; ++k) {
+                size_t i = (t + k) % specs.size();
+                if (!sameResult(simulation.run(specs[i], true), sequential[i])) failures++;
+            }
+        });
+    }
+    for (thread& worker : threads) worker.join();
+    return failures;
+}
+
+// One simulated core behaves exactly like the single-core algorithms, feedback demotions included
+int checkSingleCore() {
+    int failures = 0;
+    for (int seed = 1; seed <= 300; ++seed) {
+        Workload workload = generateWorkload(5 + seed % 60, WorkloadShape(), seed);
+        for (pair<char, int> algorithm : vector<pair<char, int>>{{'1', -1}, {'2', 1}, {'2', 3}, {'3', -1}, {'4', -1}, {'6', -1}, {'7', -1}}) {
+            SimulationContext singleCore(workload, false), oneOfMany(workload, false);
+            executeSchedulingAlgorithm(singleCore, algorithm.first, algorithm.second);
+            runMultiCore(oneOfMany, algorithm.first, algorithm.second, 1);
+            failures += singleCore.completionTime != oneOfMany.completionTime;
+        }
+    }
+    return failures;
+}
+
+// On several cores every process finishes, the cores are busy for exactly the total service time,
+// and steals never exceed dispatches. A feedback process alone on its core runs in one slice, and
+// feedback configurations are refused on several cores.
+int checkMultiCore() {
+    int failures = 0;
+    for (int seed = 1; seed <= 200; ++seed) {
+        Workload workload = generateWorkload(5 + seed % 80, WorkloadShape(), seed);
+        workload.lastMoment = INT_MAX / 2;
+        long long totalService = accumulate(workload.service.begin(), workload.service.end(), 0LL);
+        for (char algorithmId : string("123467")) {
+            for (int coreCount : {2, 3, 8}) {
+                SimulationContext context(workload, false);
+                runMultiCore(context, algorithmId, 2, coreCount);
+                long long busyTime = 0;
+                for (const CoreUsage& usage : context.coreUsage) {
+                    busyTime += usage.busyTime;
+                    failures += usage.steals > usage.dispatches;
+                }
+                failures += busyTime != totalService;
+                failures += count(context.completionTime.begin(), context.completionTime.end(), 0);
+            }
+        }
+    }
+
+    Workload twoJobs = fixedWorkload(100, {{"A", 0, 30}, {"B", 0, 30}});
+    for (char algorithmId : string("67")) {
+        SimulationContext context(twoJobs, false);
+        runMultiCore(context, algorithmId, -1, 2);
+        for (const CoreUsage& usage : context.coreUsage) failures += usage.dispatches != 1;
+    }
+    AlgorithmSpec configured = algorithmSpec(6, -1, 2);
+    configured.feedback.levelCount = 2;
+    try {
+        Simulation(twoJobs).run(configured);
+        failures++;
+    } catch (const invalid_argument&) {
+    }
+    return failures;
+}
+
+// Sweep entries expand to their configurations
+int checkSweepParsing() {
+    vector<pair<char, int>> expected = {{'1', -1}, {'2', 1}, {'2', 3}, {'2', 5}, {'8', 4}, {'8', 5}, {'8', 6}};
+    return parseSweep("1,2-1..5:2,8-4..6") != expected;
+}
+
+// Switch costs worked out by hand for RR-2 over A(0,3), B(0,3) and C(30,5), C running alone at the end.
+// A fixed cost of 1 per switch: A 0-1 lost, 1-3 run; B 3-4, 4-6; A 6-7, 7-8; B 8-9, 9-10; C 30-31, 31-36.
+// With a warm-up of 4 that is full after 10 off the CPU: A 0-5, 5-7; B 7-12, 12-14;
+// A 14-17 (7 off, 1 + 2), 17-18; B 18-20 (4 off, 1 + 1), 20-21; C cold 30-35, 35-40.
+// C's re-dispatches after its own slices are free.
+int checkSwitchCosts() {
+    int failures = 0;
+    Workload workload = fixedWorkload(50, {{"A", 0, 3}, {"B", 0, 3}, {"C", 30, 5}});
+    SimulationContext fixed(workload, false);
+    fixed.switchCosts.model.switchCost = 1;
+    executeSchedulingAlgorithm(fixed, '2', 2);
+    failures += fixed.switchCosts.switches != 5 || fixed.switchCosts.lostTime != 5;
+    failures += fixed.completionTime != vector<int>{8, 10, 36};
+
+    SimulationContext warm(workload, false);
+    warm.switchCosts.model = {1, 4, 10};
+    executeSchedulingAlgorithm(warm, '2', 2);
+    failures += warm.switchCosts.switches != 5 || warm.switchCosts.lostTime != 5 + 5 + 3 + 2 + 5;
+    failures += warm.completionTime != vector<int>{18, 21, 40};
+    return failures;
+}
+
+// Sweep means leave out unfinished processes: under FCFS with lastMoment 5 only A(0,3) finishes
+int checkRunSummary() {
+    Workload workload = fixedWorkload(5, {{"A", 0, 3}, {"B", 0, 10}});
+    SimulationContext context(workload, false);
+    executeSchedulingAlgorithm(context, '1', -1);
+    SweepResult summary = summarizeRun(context);
+    return summary.unfinished != 1 || summary.meanTurnaround != 3 || summary.meanNormalizedTurnaround != 1;
+}
+
+// A replica's means and p99 cover the same processes: the finished ones
+// Under FCFS the first 50 of them finish at 1, 2, ..., 50 and the 150 long ones never do.
+int checkReplicaMetrics() {
+    vector<tuple<string, int, int>> processes;
+    for (int i = 0; i < 200; ++i) processes.emplace_back("P" + to_string(i), 0, i < 50 ? 1 : 1000);
+    Workload workload = fixedWorkload(50, processes);
+    SimulationContext context(workload, false);
+    executeSchedulingAlgorithm(context, '1', -1);
+    ReplicaMetrics metrics = measureReplica(context);
+    return metrics.meanTurnaround != 25.5 || metrics.meanNormalizedTurnaround != 25.5 || metrics.p99Turnaround != 50;
+}
+
+// Time each process ran before the horizon
+vector<long long> runTimes(const SimulationContext& context) {
+    vector<long long> ran(context.workload.processCount, 0);
+    for (int i = 0; i < context.workload.processCount; ++i) {
+        for (const RunSegment& segment : context.executionSegments[i]) ran[i] += segment.end - segment.start;
+    }
+    return ran;
+}
+
+// Shares hold with weights far beyond the old 64-bit pass scale: total weight 1e9 for stride,
+// single weights of 2e9 and 1e9 for CFS
+int checkFairShareLargeWeights() {
+    int failures = 0;
+    vector<tuple<string, int, int>> processes;
+    for (int i = 0; i < 100; ++i) processes.emplace_back("P" + to_string(i), 0, 10000000);
+    processes.emplace_back("Late", 1000, 10000000);
+    Workload crowded = fixedWorkload(2010, processes);
+    SimulationContext stride(crowded, true);
+    executeSchedulingAlgorithm(stride, STRIDE_ID, 1);
+    long long lateShare = runTimes(stride).back(); // About 1010 / 101 with equal weights
+    failures += lateShare < 5 || lateShare > 15;
+
+    Workload heavy = fixedWorkload(3000, {{"A", 0, 2000000000}, {"B", 0, 1000000000}});
+    SimulationContext fair(heavy, true);
+    executeSchedulingAlgorithm(fair, CFS_ID, 1);
+    vector<long long> ran = runTimes(fair);
+    failures += abs(ran[0] - 2000) > 2 || abs(ran[1] - 1000) > 2;
+    return failures;
+}
+
+// A workload written in the binary format reads back column for column
+int checkBinaryFormat() {
+    Workload workload = generateWorkload(500, WorkloadShape(), 3);
+    workload.operationMode = "stats";
+    workload.schedulingAlgorithms = {{'1', -1}, {'2', 4}, {'8', 1}, {'0' + ALGORITHM_COUNT, 2}};
+    string path = "/tmp/checks-" + to_string(getpid()) + ".bin";
+    writeBinaryWorkload(workload, path);
+    ifstream file(path, ios::binary);
+    string data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    remove(path.c_str());
+
+    if (!isBinaryWorkload(data)) return 1;
+    Workload loaded;
+    parseBinaryWorkload(data, loaded);
+    return (loaded.operationMode != workload.operationMode) + (loaded.schedulingAlgorithms != workload.schedulingAlgorithms) +
+           (loaded.lastMoment != workload.lastMoment) + (loaded.processCount != workload.processCount) +
+           (loaded.arrival != workload.arrival) + (loaded.service != workload.service) +
+           (loaded.nameOffsets != workload.nameOffsets) + (loaded.names != workload.names);
+}
+
+// A Chrome trace is one JSON array whose waits pair up and whose run slices add up to the CPU time used
+int checkChromeTrace() {
+    Workload workload = generateWorkload(300, WorkloadShape(), 5);
+    workload.lastMoment = INT_MAX / 2;
+    string path = "/tmp/checks-" + to_string(getpid()) + ".json";
+    vector<pair<char, int>> algorithms = {{'2', 3}, {'7', -1}, {CFS_ID, 2}};
+    long long totalService = accumulate(workload.service.begin(), workload.service.end(), 0LL);
+    {
+        ChromeTraceFile traceFile(path);
+        if (!traceFile.isOpen()) return 1;
+        for (int run = 0; run < (int)algorithms.size(); ++run) {
+            ChromeTraceWriter writer(traceFile, workload, run, algorithmName(algorithms[run]), 1, 4096);
+            SimulationContext context(workload, false);
+            context.chromeTrace = &writer;
+            executeSchedulingAlgorithm(context, algorithms[run].first, algorithms[run].second);
+            writer.finish();
+        }
+        if (!traceFile.close()) return 1;
+    }
+    ifstream file(path);
+    string trace((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    remove(path.c_str());
+
+    auto occurrences = [&](const string& text) {
+        long long found = 0;
+        for (size_t at = trace.find(text); at != string::npos; at = trace.find(text, at + 1)) found++;
+        return found;
+    };
+    long long runTime = 0;
+    for (size_t at = trace.find("\"cat\":\"run\""); at != string::npos; at = trace.find("\"cat\":\"run\"", at + 1)) {
+        runTime += atoll(trace.c_str() + trace.find("\"dur\":", at) + 6);
+    }
+    int failures = 0;
+    failures += trace.rfind("[\n{", 0) != 0 || trace.size() < 3 || trace.compare(trace.size() - 3, 3, "\n]\n") != 0;
+    failures += occurrences("\"ph\":\"b\"") != occurrences("\"ph\":\"e\"");
+    failures += occurrences("\n{") != occurrences("}\n") + occurrences("},\n");
+    failures += runTime != totalService * (long long)algorithms.size();
+    return failures;
+}
+
+int main() {
+    vector<pair<string, int (*)()>> checks = {
+        {"snapshot resume", checkSnapshotResume},
+        {"concurrent runs", checkConcurrentRuns},
+        {"single core", checkSingleCore},
+        {"multi-core", checkMultiCore},
+        {"sweep parsing", checkSweepParsing},
+        {"switch costs", checkSwitchCosts},
+        {"run summary", checkRunSummary},
+        {"replica metrics", checkReplicaMetrics},
+        {"fair share with large weights", checkFairShareLargeWeights},
+        {"binary format", checkBinaryFormat},
+        {"chrome trace", checkChromeTrace},
+    };
+    int failed = 0;
+    for (const auto& [name, check] : checks) {
+        int failures = check();
+        if (failures == 0) {
+            cout << name << ": ok" << endl;
+        } else {
+            cout << name << ": " << failures << " failures" << endl;
+            failed++;
+        }
+    }
+    return failed > 0;
+}
@@ -1,572 +1,633 @@
 
 #include <bits/stdc++.h>
 #include "scheduler_parser.h"
+#include "scheduler_algorithms.h"
+#include "scheduler_output.h"
+#include "scheduler_metrics.h"
+#include "scheduler_multicore.h"
+#include "scheduler_sweep.h"
+#include "scheduler_stream.h"
+#include "scheduler_percentiles.h"
+#include "scheduler_montecarlo.h"
+#include "scheduler_chrome_trace.h"
 
 using namespace std;
 
 /** Global Constants **/
 const string TRACE_MODE = "trace";
 const string STATS_MODE = "statistics";
-const string SCHEDULING_ALGORITHMS[9] = {"", "FCFS", "RR", "SPN", "SRT", "HRRN", "FB-1", "FB-2i", "AGING"};
 
-// Comparator functions for sorting
-bool compareByServiceTime(const tuple<string, int, int>& a, const tuple<string, int, int>& b) {
-    return get<2>(a) < get<2>(b);
+// Print functions
+void printAlgorithm(const Workload& workload, int index, OutputBuffer& out) {
+    out.write(SCHEDULING_ALGORITHMS[workload.schedulingAlgorithms[index].first - '0']);
+    if (workload.schedulingAlgorithms[index].second > 0) {
+        out.write('-');
+        out.writeInt(workload.schedulingAlgorithms[index].second);
+    }
+    out.write('\n');
 }
 
-bool compareByArrivalTime(const tuple<string, int, int>& a, const tuple<string, int, int>& b) {
-    return get<1>(a) < get<1>(b);
+void printProcesses(const Workload& workload, OutputBuffer& out) {
+    out.write("Process    ");
+    for (int i = 0; i < workload.processCount; ++i) {
+        out.write("|  ");
+        out.write(workload.name(i));
+        out.write("  ");
+    }
+    out.write("|\n");
 }
 
-bool compareByResponseRatio(const tuple<string, double, int>& a, const tuple<string, double, int>& b) {
-    return get<1>(a) > get<1>(b);
+void printArrivalTime(const Workload& workload, OutputBuffer& out)
+{
+    out.write("Arrival    ");
+    for (int i = 0; i < workload.processCount; i++) {
+        out.write('|');
+        out.writeInt(workload.arrival[i], 3);
+        out.write("  ");
+    }
+    out.write("|\n");
 }
-
-bool compareByPriority(const tuple<int, int, int>& a, const tuple<int, int, int>& b) {
-    if (get<0>(a) == get<0>(b)) {
-        return get<2>(a) > get<2>(b);
+void printServiceTime(const Workload& workload, OutputBuffer& out)
+{
+    out.write("Service    |");
+    for (int i = 0; i < workload.processCount; i++) {
+        out.writeInt(workload.service[i], 3);
+        out.write("  |");
     }
-    return get<0>(a) > get<0>(b);
+    out.write(" Mean|\n");
 }
-
-// Function to clear the timeline matrix
-void resetTimeline() {
-    for (int i = 0; i < lastMoment; ++i) {
-        for (int j = 0; j < processCount; ++j) {
-            executionTimeline[i][j] = ' ';
-        }
+void printFinishTime(const SimulationContext& context, OutputBuffer& out)
+{
+    out.write("Finish     ");
+    for (int i = 0; i < context.workload.processCount; i++) {
+        out.write('|');
+        out.writeInt(context.completionTime[i], 3);
+        out.write("  ");
     }
+    out.write("|-----|\n");
 }
 
-// Utility functions to access tuple components
-string extractProcessName(const tuple<string, int, int>& process) {
-    return get<0>(process);
+// Two-decimal value in a five character column, padded on the left below 10
+void printMeanColumn(double value, OutputBuffer& out) {
+    if (value < 10)
+        out.write(' ');
+    out.writeFixed(value, 2);
+    out.write('|');
 }
 
-int extractArrivalTime(const tuple<string, int, int>& process) {
-    return get<1>(process);
+void printTurnAroundTime(const SimulationContext& context, OutputBuffer& out)
+{
+    out.write("Turnaround |");
+    long long sum = 0;
+    for (int i = 0; i < context.workload.processCount; i++)
+    {
+        out.writeInt(context.turnaroundTime[i], 3);
+        out.write("  |");
+        sum += context.turnaroundTime[i];
+    }
+    printMeanColumn(1.0 * sum / context.turnaroundTime.size(), out);
+    out.write('\n');
 }
 
-int extractServiceTime(const tuple<string, int, int>& process) {
-    return get<2>(process);
+void printNormTurn(const SimulationContext& context, OutputBuffer& out)
+{
+    out.write("NormTurn   |");
+    float sum = 0; // float on purpose: the Mean column rounds exactly as the reference output does
+    for (int i = 0; i < context.workload.processCount; i++)
+    {
+        printMeanColumn(context.normalizedTurnaround[i], out);
+        sum += context.normalizedTurnaround[i];
+    }
+    printMeanColumn(1.0 * sum / context.normalizedTurnaround.size(), out);
+    out.write('\n');
 }
 
-int getPriorityLevel(tuple<string, int, int> &process)
-{
-    return get<2>(process);
+// Switches, the CPU time they cost and the resulting throughput, under a switch cost model
+void printSwitchCosts(const SimulationContext& context, OutputBuffer& out) {
+    SweepResult summary = summarizeRun(context);
+    out.write("Switches   | ");
+    out.writeInt(context.switchCosts.switches);
+    out.write("\nLost CPU   | ");
+    out.writeInt(context.switchCosts.lostTime);
+    out.write("\nThroughput | ");
+    out.writeFixed(summary.throughput, 4);
+    out.write('\n');
+    // Overhead pushes completions later, possibly past lastMoment
+    if (summary.unfinished > 0) {
+        out.write("Unfinished | ");
+        out.writeInt(summary.unfinished);
+        out.write('\n');
+    }
 }
 
-// Calculate the response ratio
-double computeResponseRatio(int waitingTime, int serviceTime) {
-    return (waitingTime + serviceTime) * 1.0 / serviceTime;
+void printStats(const SimulationContext& context, int index, OutputBuffer& out) {
+    printAlgorithm(context.workload, index, out);
+    printProcesses(context.workload, out);
+    printArrivalTime(context.workload, out);
+    printServiceTime(context.workload, out);
+    printFinishTime(context, out);
+    printTurnAroundTime(context, out);
+    printNormTurn(context, out);
 }
 
-// Fill in wait time on the timeline
-void markWaitingTimes() {
-    for (int i = 0; i < processCount; ++i) {
-        int arrivalTime = extractArrivalTime(processList[i]);
-        for (int t = arrivalTime; t < completionTime[i]; ++t) {
-            if (executionTimeline[t][i] != '*') {
-                executionTimeline[t][i] = '.';
-            }
-        }
+// One percentile column: an integer, or a value in thousandths with two decimals
+void printPercentileCell(uint64_t value, bool thousandths, OutputBuffer& out) {
+    if (thousandths) {
+        char text[32];
+        int length = snprintf(text, sizeof(text), "%7.2f", value / (double)NORMALIZED_SCALE);
+        out.write(string_view(text, length));
+    } else {
+        out.writeInt(value, 7);
     }
+    out.write('|');
 }
 
-// First-Come-First-Serve (FCFS) scheduling algorithm
-void runFCFS() {
-    int currentTime = extractArrivalTime(processList[0]);
-    for (int i = 0; i < processCount; ++i) {
-        int arrival = extractArrivalTime(processList[i]);
-        int service = extractServiceTime(processList[i]);
-
-        if(currentTime < arrival) currentTime = arrival;
-
-        completionTime[i] = currentTime + service;
-        turnaroundTime[i] = completionTime[i] - arrival;
-        normalizedTurnaround[i] = (turnaroundTime[i] * 1.0) / service;
-
-        for (int t = currentTime; t < completionTime[i]; ++t) {
-            executionTimeline[t][i] = '*';
-        }
-        for (int t = arrival; t < currentTime; ++t) {
-            executionTimeline[t][i] = '.';
-        }
-
-        currentTime += service;
+void printPercentileRow(const char* label, const LatencyHistogram& histogram, const vector<string>& percentiles, bool thousandths, OutputBuffer& out) {
+    out.write(label);
+    for (const string& percentile : percentiles) {
+        printPercentileCell(histogram.percentile(stod(percentile) / 100), thousandths, out);
     }
+    printPercentileCell(histogram.maximum(), thousandths, out);
+    out.write('\n');
 }
 
-// Round Robin (RR) scheduling algorithm
-void runRoundRobin(int quantum) {
-    queue<pair<int, int>> readyQueue; // Index, Remaining Service Time
-    int currentIndex = 0;
-
-    // Add the first process if it arrives at time 0
-    if (currentIndex < processCount && extractArrivalTime(processList[currentIndex]) == 0) {
-        readyQueue.push({currentIndex, extractServiceTime(processList[currentIndex])});
-        ++currentIndex;
+// Tail of the turnaround, waiting and normalized turnaround distributions, below the statistics table
+void printPercentiles(const LatencySummary& summary, const vector<string>& percentiles, OutputBuffer& out) {
+    out.write("Percentile |");
+    for (const string& percentile : percentiles) {
+        out.writeRepeated(" ", 6 - (int)percentile.size());
+        out.write('p');
+        out.write(percentile);
+        out.write('|');
     }
-
-    int currentQuantum = quantum; // Initialize the quantum for the first process
-
-    for (int time = 0; time < lastMoment; ++time) {
-        // Add new arrivals to the ready queue before process execution to ensure correct order of preemption
-        while (currentIndex < processCount && extractArrivalTime(processList[currentIndex]) == time + 1) {
-            readyQueue.push({currentIndex, extractServiceTime(processList[currentIndex])});
-            ++currentIndex;
-        }
-
-        if (!readyQueue.empty()) {
-            // Process at the front of the queue
-            int processIndex = readyQueue.front().first;
-            int &remainingService = readyQueue.front().second;
-
-            // Execute the current process
-            executionTimeline[time][processIndex] = '*';
-            --remainingService;
-            --currentQuantum;
-
-            if (currentQuantum == 0 && remainingService == 0) { 
-                // Process completes
-                completionTime[processIndex] = time + 1;
-                turnaroundTime[processIndex] = completionTime[processIndex] - extractArrivalTime(processList[processIndex]);
-                normalizedTurnaround[processIndex] = (turnaroundTime[processIndex] * 1.0) / extractServiceTime(processList[processIndex]);
-                readyQueue.pop();
-                currentQuantum = quantum; // Reset quantum
-            } else if (currentQuantum == 0 && remainingService != 0) {
-                // Quantum expires, preempt the process
-                readyQueue.push({processIndex, remainingService});
-                readyQueue.pop();
-                currentQuantum = quantum; // Reset quantum
-            } else if(currentQuantum != 0 && remainingService == 0){
-                // Process completes
-                completionTime[processIndex] = time + 1;
-                turnaroundTime[processIndex] = completionTime[processIndex] - extractArrivalTime(processList[processIndex]);
-                normalizedTurnaround[processIndex] = (turnaroundTime[processIndex] * 1.0) / extractServiceTime(processList[processIndex]);
-                readyQueue.pop();
-                currentQuantum = quantum; // Reset quantum
-            }
-        }
-
-        // Check for new arrivals after process execution
-        while (currentIndex < processCount && extractArrivalTime(processList[currentIndex]) == time + 1) {
-            readyQueue.push({currentIndex, extractServiceTime(processList[currentIndex])});
-            ++currentIndex;
-        }
+    out.write("    max|\n");
+    printPercentileRow("Turnaround |", summary.turnaround, percentiles, false, out);
+    printPercentileRow("Waiting    |", summary.waiting, percentiles, false, out);
+    printPercentileRow("NormTurn   |", summary.normalizedTurnaround, percentiles, true, out);
+    if (summary.unfinished > 0) {
+        out.write("Unfinished | ");
+        out.writeInt(summary.unfinished);
+        out.write('\n');
     }
-
-    markWaitingTimes(); // Calculate waiting times for all processes
 }
 
-// Shortest Process Next (SPN) scheduling algorithm
-void runSPN() { // Non Preemptive
-    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> readyQueue; // Pair of Service Time and Index
-    int currentIndex = 0;
-
-    for (int time = 0; time < lastMoment; ++time) {
-        while (currentIndex < processCount && extractArrivalTime(processList[currentIndex]) <= time) {
-            readyQueue.push({extractServiceTime(processList[currentIndex]), currentIndex});
-            ++currentIndex;
-        }
-
-        if (!readyQueue.empty()) {
-            int processIndex = readyQueue.top().second;
-            readyQueue.pop();
-
-            for (int t = time; t < time + extractServiceTime(processList[processIndex]); ++t) {
-                executionTimeline[t][processIndex] = '*';
-            }
+/*
+ * Algorithm name in the six character column in front of the trace header.
+ * Algorithms 1-8 keep the labels of the reference output. The others print their
+ * full name with its quantum, as algorithmName does, and widen the column when it
+ * does not fit; the return value is how many characters the column grew by.
+ */
+int printTraceLabel(const Workload& workload, int index, OutputBuffer& out) {
+    int quantum = workload.schedulingAlgorithms[index].second;
+    switch (workload.schedulingAlgorithms[index].first)
+    {
+    case '1': out.write("FCFS  "); return 0;
+    case '2': out.write("RR-"); out.writeInt(quantum); out.write("  "); return 0;
+    case '3': out.write("SPN   "); return 0;
+    case '4': out.write("SRT   "); return 0;
+    case '5': out.write("HRRN  "); return 0;
+    case '6': out.write("FB-1  "); return 0;
+    case '7': out.write("FB-2i "); return 0;
+    case '8': out.write("Aging "); return 0;
+    }
+    string label = algorithmName(workload.schedulingAlgorithms[index]);
+    int widening = max(0, (int)label.size() - 5);
+    out.write(label);
+    out.writeRepeated(" ", 6 + widening - (int)label.size());
+    return widening;
+}
 
-            completionTime[processIndex] = time + extractServiceTime(processList[processIndex]);
-            turnaroundTime[processIndex] = completionTime[processIndex] - extractArrivalTime(processList[processIndex]);
-            normalizedTurnaround[processIndex] = (turnaroundTime[processIndex] * 1.0) / extractServiceTime(processList[processIndex]);
+// Cells in [from, to) where the process is not running: waiting between arrival and finish, blank otherwise
+void printIdleCells(const SimulationContext& context, int processIndex, int from, int to, OutputBuffer& out) {
+    const Workload& workload = context.workload;
+    int waitStart = max(from, min(workload.arrival[processIndex], to));
+    int waitEnd = max(waitStart, min(context.completionTime[processIndex], to));
+    out.writeRepeated(" |", waitStart - from);
+    out.writeRepeated(".|", waitEnd - waitStart);
+    out.writeRepeated(" |", to - waitEnd);
+}
 
-            time = completionTime[processIndex] - 1;
+// The trace is rendered one process row at a time, straight from the run segments
+void printTimeline(const SimulationContext& context, int index, OutputBuffer& out) {
+    const Workload& workload = context.workload;
+    int widening = printTraceLabel(workload, index, out);
+    for (int i = 0; i <= workload.lastMoment; i++) {
+        out.write('0' + i % 10);
+        out.write(' ');
+    }
+    out.write('\n');
+    out.writeRepeated("-", widening);
+    out.write("------------------------------------------------\n");
+    for (int i = 0; i < workload.processCount; i++)
+    {
+        out.write(workload.name(i));
+        out.writeRepeated(" ", widening);
+        out.write("     |");
+        int time = 0;
+        for (const RunSegment& segment : context.executionSegments[i])
+        {
+            int start = min(segment.start, workload.lastMoment);
+            int end = min(segment.end, workload.lastMoment);
+            printIdleCells(context, i, time, start, out);
+            out.writeRepeated("*|", end - start);
+            time = end;
         }
+        printIdleCells(context, i, time, workload.lastMoment, out);
+        out.write(" \n");
     }
-    markWaitingTimes();
+    out.writeRepeated("-", widening);
+    out.write("------------------------------------------------\n");
 }
 
-// Shortest Remaining Time (SRT) scheduling algorithm
-void runSRT() {
-    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> readyQueue; // Pair of Remaining Service Time and Index
-    int currentIndex = 0;
-
-    for (int time = 0; time < lastMoment; ++time) {
-        while (currentIndex < processCount && extractArrivalTime(processList[currentIndex]) == time) {
-            readyQueue.push({extractServiceTime(processList[currentIndex]), currentIndex});
-            ++currentIndex;
-        }
+// Per-core table of a multi-core run: busy time, utilisation until the last slice ends, dispatches and steals
+void printCoreUsage(const SimulationContext& context, OutputBuffer& out) {
+    int coreCount = context.coreUsage.size();
+    out.write("Core       |");
+    for (int core = 0; core < coreCount; ++core) {
+        out.writeInt(core, 3);
+        out.write("  |");
+    }
+    out.write("\nBusy       |");
+    for (const CoreUsage& usage : context.coreUsage) {
+        out.writeInt(usage.busyTime, 3);
+        out.write("  |");
+    }
+    out.write("\nUtil %     |");
+    for (const CoreUsage& usage : context.coreUsage) {
+        out.writeInt(context.makespan ? llround(100.0 * usage.busyTime / context.makespan) : 0, 3);
+        out.write("  |");
+    }
+    out.write("\nDispatches |");
+    for (const CoreUsage& usage : context.coreUsage) {
+        out.writeInt(usage.dispatches, 3);
+        out.write("  |");
+    }
+    out.write("\nSteals     |");
+    for (const CoreUsage& usage : context.coreUsage) {
+        out.writeInt(usage.steals, 3);
+        out.write("  |");
+    }
+    out.write("\nMigrations | ");
+    out.writeInt(context.migrations);
+    out.write('\n');
+}
 
-        if (!readyQueue.empty()) {
-            int processIndex = readyQueue.top().second;
-            int remainingTime = readyQueue.top().first;
-            readyQueue.pop();
+void printSweepHeader(bool switchCosts, OutputBuffer& out) {
+    out.write("Sweep       |  Turnaround |    NormTurn |  Unfinished |");
+    if (switchCosts) out.write("    Lost CPU |  Throughput |");
+    out.write('\n');
+}
 
-            executionTimeline[time][processIndex] = '*';
+void printSweepRow(const Workload& workload, int index, const SweepResult& result, bool switchCosts, OutputBuffer& out) {
+    char row[128];
+    int length = snprintf(row, sizeof(row), "%-12s|%12.2f |%12.2f |%12d |", algorithmName(workload.schedulingAlgorithms[index]).c_str(),
+                          result.meanTurnaround, result.meanNormalizedTurnaround, result.unfinished);
+    if (switchCosts) length += snprintf(row + length, sizeof(row) - length, "%12lld |%12.4f |", result.lostTime, result.throughput);
+    row[length++] = '\n';
+    out.write(string_view(row, length));
+}
 
-            if (remainingTime > 1) {
-                readyQueue.push({remainingTime - 1, processIndex});
-            } else {
-                completionTime[processIndex] = time + 1;
-                turnaroundTime[processIndex] = completionTime[processIndex] - extractArrivalTime(processList[processIndex]);
-                normalizedTurnaround[processIndex] = (turnaroundTime[processIndex] * 1.0) / extractServiceTime(processList[processIndex]);
-            }
-        }
+/*
+ * Best configuration of every swept algorithm, by mean turnaround and by mean normalized turnaround.
+ * Means only cover finished processes, so configurations that left processes unfinished rank
+ * behind every one that finished them all, fewest unfinished first.
+ */
+void printSweepBest(const Workload& workload, const vector<SweepResult>& results, OutputBuffer& out) {
+    auto better = [&](int i, int j, double SweepResult::*mean) {
+        return make_pair(results[i].unfinished, results[i].*mean) < make_pair(results[j].unfinished, results[j].*mean);
+    };
+    map<char, pair<int, int>> best; // Algorithm ID to the index of the best turnaround and normalized turnaround
+    for (int i = 0; i < (int)results.size(); ++i) {
+        auto found = best.try_emplace(workload.schedulingAlgorithms[i].first, i, i);
+        pair<int, int>& indices = found.first->second;
+        if (better(i, indices.first, &SweepResult::meanTurnaround)) indices.first = i;
+        if (better(i, indices.second, &SweepResult::meanNormalizedTurnaround)) indices.second = i;
+    }
+    for (const auto& [algorithmId, indices] : best) {
+        char line[256];
+        int length = snprintf(line, sizeof(line), "Best %s: %s (turnaround %.2f), %s (normturn %.2f)\n",
+                              SCHEDULING_ALGORITHMS[algorithmId - '0'].c_str(),
+                              algorithmName(workload.schedulingAlgorithms[indices.first]).c_str(), results[indices.first].meanTurnaround,
+                              algorithmName(workload.schedulingAlgorithms[indices.second]).c_str(), results[indices.second].meanNormalizedTurnaround);
+        out.write(string_view(line, length));
     }
-    markWaitingTimes();
 }
 
-void runHRRN() {
-    vector<tuple<string, double, int>> readyQueue; // Vector of tuple <process_name, process_response_ratio, time_in_service> for processes that are in the ready queue
-    int currentIndex = 0;
+// Mean with its 95% confidence interval in a column of the replica table
+string formatInterval(const ConfidenceInterval& interval) {
+    char cell[64];
+    snprintf(cell, sizeof(cell), "%10.2f +-%8.2f |", interval.mean, interval.halfWidth);
+    return cell;
+}
 
-    for (int time = 0; time < lastMoment; ++time) {
-        while (currentIndex < processCount && extractArrivalTime(processList[currentIndex]) <= time) {
-            readyQueue.push_back(make_tuple(extractProcessName(processList[currentIndex]), 1.0, 0)); // Initialize response ratio and service time tracker
-            currentIndex++;
-        }
+/*
+ * Replica table: for every algorithm the mean over the replicas of its mean turnaround,
+ * mean normalized turnaround and 99th percentile turnaround, each with a 95% confidence
+ * interval, and its mean turnaround minus that of the best algorithm. The difference is
+ * taken within each replica, since all algorithms run on the same replicas, which gives
+ * a much narrower interval than comparing the separate intervals.
+ */
+void printReplicaSummary(const Workload& workload, const WorkloadShape& shape, uint64_t seed,
+                         const vector<vector<ReplicaMetrics>>& metrics, OutputBuffer& out) {
+    int replicaCount = metrics.size();
+    int algorithmCount = workload.schedulingAlgorithms.size();
+    char line[256];
+    int length = snprintf(line, sizeof(line), "Replicas    | %d of %d processes, %s arrivals, %s service, seed %llu\n",
+                          replicaCount, workload.processCount, shape.arrivals.c_str(), shape.service.c_str(), (unsigned long long)seed);
+    out.write(string_view(line, length));
+    out.write("Algorithm   |           Turnaround |             NormTurn |       p99 Turnaround |          vs best |\n");
+
+    vector<ConfidenceInterval> turnaround(algorithmCount);
+    int best = 0;
+    for (int a = 0; a < algorithmCount; ++a) {
+        vector<double> samples;
+        for (int r = 0; r < replicaCount; ++r) samples.push_back(metrics[r][a].meanTurnaround);
+        turnaround[a] = confidenceInterval(samples);
+        if (turnaround[a].mean < turnaround[best].mean) best = a;
+    }
 
-        for (auto& process : readyQueue) {
-            string name = get<0>(process);
-            int idx = processIndexMap[name];
-            int waitTime = time - extractArrivalTime(processList[idx]);
-            get<1>(process) = computeResponseRatio(waitTime, extractServiceTime(processList[idx]));
+    for (int a = 0; a < algorithmCount; ++a) {
+        vector<double> normalized, tail, difference;
+        for (int r = 0; r < replicaCount; ++r) {
+            normalized.push_back(metrics[r][a].meanNormalizedTurnaround);
+            tail.push_back(metrics[r][a].p99Turnaround);
+            difference.push_back(metrics[r][a].meanTurnaround - metrics[r][best].meanTurnaround);
         }
-        //Sort from Higher to Lower Response Ratio
-        sort(readyQueue.begin(), readyQueue.end(), compareByResponseRatio);
-
-        if (!readyQueue.empty()) {
-            int idx = processIndexMap[get<0>(readyQueue[0])];
-            for (int t = time; t < time + extractServiceTime(processList[idx]) && t < lastMoment; ++t) {
-                executionTimeline[t][idx] = '*';
-                get<2>(readyQueue[0])++;
-            }
-            completionTime[idx] = time + extractServiceTime(processList[idx]);
-            turnaroundTime[idx] = completionTime[idx] - extractArrivalTime(processList[idx]);
-            normalizedTurnaround[idx] = (turnaroundTime[idx] * 1.0) / extractServiceTime(processList[idx]);
-
-            readyQueue.erase(readyQueue.begin());
-            time = completionTime[idx] - 1;
+        length = snprintf(line, sizeof(line), "%-12s|", algorithmName(workload.schedulingAlgorithms[a]).c_str());
+        out.write(string_view(line, length));
+        out.write(formatInterval(turnaround[a]));
+        out.write(formatInterval(confidenceInterval(normalized)));
+        out.write(formatInterval(confidenceInterval(tail)));
+        if (a == best) {
+            out.write("             best |\n");
+        } else {
+            ConfidenceInterval gap = confidenceInterval(difference);
+            length = snprintf(line, sizeof(line), "%+8.2f +-%6.2f |\n", gap.mean, gap.halfWidth);
+            out.write(string_view(line, length));
         }
     }
-    markWaitingTimes();
 }
 
-// Feedback Queue 1 (FB-Q1) scheduling algorithm
-void runFeedbackQ1() {
-    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> readyQueue; //Pair of Priority Level and Process Index
-    vector<int> remainingTime(processCount);
-    for (int i = 0; i < processCount; ++i) {
-        remainingTime[i] = extractServiceTime(processList[i]);
+/*
+ * Run task(0) .. task(taskCount - 1) on a pool of worker threads, one per
+ * hardware thread unless threadCount is given.
+ * Workers pull the next task index from a shared counter until none are left.
+ * If given, consume(i) is called on the calling thread in index order as soon
+ * as task i has finished, while later tasks keep running.
+ */
+void runInParallel(int taskCount, const function<void(int)>& task, const function<void(int)>& consume = nullptr, int threadCount = 0) {
+    int workerCount = min<int>(taskCount, threadCount > 0 ? threadCount : max(1u, thread::hardware_concurrency()));
+    atomic<int> nextTask(0);
+    vector<char> finished(taskCount, false);
+    mutex finishedMutex;
+    condition_variable taskFinished;
+
+    vector<thread> workers;
+    for (int w = 0; w < workerCount; ++w) {
+        workers.emplace_back([&]() {
+            for (int i = nextTask++; i < taskCount; i = nextTask++) {
+                task(i);
+                lock_guard<mutex> lock(finishedMutex);
+                finished[i] = true;
+                taskFinished.notify_all();
+            }
+        });
     }
 
-    int currentIndex = 0;
-
-    if (extractArrivalTime(processList[0])==0) {
-        readyQueue.push({0,currentIndex});
-        currentIndex++;
+    for (int i = 0; consume && i < taskCount; ++i) {
+        unique_lock<mutex> lock(finishedMutex);
+        taskFinished.wait(lock, [&]() { return finished[i] != 0; });
+        lock.unlock();
+        consume(i);
     }
 
-    for (int time = 0; time < lastMoment; ++time) {
-        if (!readyQueue.empty()) {
-            int priorityLevel = readyQueue.top().first;
-            int processIndex =readyQueue.top().second;
-            readyQueue.pop();
-
-            while (currentIndex < processCount && extractArrivalTime(processList[currentIndex]) == time + 1) {
-                readyQueue.push({0, currentIndex});
-                currentIndex++;
-            }
-
-            executionTimeline[time][processIndex] = '*';
-            remainingTime[processIndex]--;
-
-            if (remainingTime[processIndex] == 0) {
-                completionTime[processIndex] = time + 1;
-                turnaroundTime[processIndex] = completionTime[processIndex] - extractArrivalTime(processList[processIndex]);
-                normalizedTurnaround[processIndex] = (turnaroundTime[processIndex] * 1.0) / extractServiceTime(processList[processIndex]);
-            } else {
-                if (readyQueue.size()>=1)
-                    readyQueue.push({priorityLevel+1,processIndex});
-                else
-                    readyQueue.push({priorityLevel,processIndex});
-            }
-        }
-        while (currentIndex < processCount && extractArrivalTime(processList[currentIndex]) == time + 1) {
-            readyQueue.push({0, currentIndex});
-            remainingTime[currentIndex] = extractServiceTime(processList[currentIndex]);
-            currentIndex++;
-        }
+    for (thread& worker : workers) {
+        worker.join();
     }
-    markWaitingTimes();
 }
 
-// Aging scheduling algorithm
-void runAging(int quantum)
-{
-    // Ready queue: priority level, process index, and total waiting time.
-    vector<tuple<int, int, int>> v;
-    unordered_map<int, int> remainingTime; // Map to track remaining service time.
-    int currentIndex = 0, currentProcess = -1;
-
-    // Main simulation loop.
-    for (int time = 0; time < lastMoment; time++) {
-        // Add new arrivals to the ready queue.
-        while (currentIndex < processCount && extractArrivalTime(processList[currentIndex]) <= time) {
-            v.push_back({getPriorityLevel(processList[currentIndex]), currentIndex, 0});
-            remainingTime[currentIndex] = extractServiceTime(processList[currentIndex]);
-            currentIndex++;
+int main(int argc, char* argv[]) {
+    // Options: "--convert <file>" stores the workload in the binary format instead of simulating it,
+    // "--metrics <file>" writes per-run counters and phase timings as JSON,
+    // "--cores <n>" simulates n CPUs with per-core ready queues,
+    // "--sweep <ranges>" replaces the algorithm list with a sweep and prints only the means,
+    // "--stream <algorithm>" simulates a stream of job lines and prints each completion,
+    // "--levels <n>", "--quanta <q0,q1,...>" and "--boost <period>" reshape the FB-1 and FB-2i queues,
+    // "--percentiles <p,...>" adds those percentiles and the maximum to the statistics output,
+    // "--switch-cost <c>" and "--warmup <w>[,<cold after>]" charge CPU time for every process switch,
+    // "--replicas <k>" runs the algorithms on k random workloads fitted to the input (drawn from "--seed <s>")
+    // and prints confidence intervals, "--threads <n>" caps the worker threads,
+    // "--chrome-trace <file>" streams every run to a Chrome trace-event file
+    string convertPath, metricsPath, sweepSpecification, streamAlgorithm, chromeTracePath;
+    vector<string> percentiles;
+    SwitchCostModel switchCost;
+    int coreCount = 1;
+    int replicaCount = 0;
+    int threadCount = 0;
+    uint64_t seed = 1;
+    FeedbackConfig feedback;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string option = argv[i];
+        if (option == "--convert") convertPath = argv[i + 1];
+        else if (option == "--metrics") metricsPath = argv[i + 1];
+        else if (option == "--chrome-trace") chromeTracePath = argv[i + 1];
+        else if (option == "--cores") coreCount = max(1, atoi(argv[i + 1]));
+        else if (option == "--sweep") sweepSpecification = argv[i + 1];
+        else if (option == "--stream") streamAlgorithm = argv[i + 1];
+        else if (option == "--levels") feedback.levelCount = max(1, atoi(argv[i + 1]));
+        else if (option == "--percentiles") percentiles = parsePercentiles(argv[i + 1]);
+        else if (option == "--boost") feedback.boostPeriod = max(0LL, atoll(argv[i + 1]));
+        else if (option == "--replicas") replicaCount = max(0, atoi(argv[i + 1]));
+        else if (option == "--seed") seed = strtoull(argv[i + 1], nullptr, 10);
+        else if (option == "--threads") threadCount = max(0, atoi(argv[i + 1]));
+        else if (option == "--switch-cost") switchCost.switchCost = max(0LL, atoll(argv[i + 1]));
+        else if (option == "--warmup") {
+            string warmup = argv[i + 1];
+            size_t comma = warmup.find(',');
+            switchCost.warmupCost = max(0LL, atoll(warmup.substr(0, comma).c_str()));
+            if (comma != string::npos) switchCost.coldAfter = max(0LL, atoll(warmup.substr(comma + 1).c_str()));
         }
-
-        // Skip if no processes are ready.
-        if (v.empty()) {
-            continue;
+        else if (option == "--quanta") {
+            stringstream quantaStream(argv[i + 1]);
+            string quantum;
+            while (getline(quantaStream, quantum, ',')) feedback.quanta.push_back(max(1LL, atoll(quantum.c_str())));
         }
+    }
 
-        // Sort the queue by priority.
-        sort(v.begin(), v.end(), compareByPriority);
-
-        // Select the process with the highest priority.
-        currentProcess = get<1>(v[0]);
-
-        // Adjust priorities for all processes in the queue.
-        for (int i = 0; i < v.size(); i++) {
-            if(i != 0) {
-                // Increment priority and waiting time for waiting processes.
-                get<0>(v[i])++;
-                get<2>(v[i])++;
-            }
+    if (!streamAlgorithm.empty()) {
+        vector<pair<char, int>> algorithm = parseAlgorithms(streamAlgorithm);
+        if (algorithm.size() != 1 || !isComposedAlgorithm(algorithm[0].first)) {
+            cerr << "Streaming supports one of FCFS, RR, SPN, SRT, FB-1 or FB-2i" << endl;
+            return 1;
         }
-
-        // Execute the selected process for its quantum or until finished.
-        int currentQuantum = quantum;
-        while (currentQuantum-- && remainingTime[currentProcess] > 0 && time < lastMoment) {
-            executionTimeline[time][currentProcess] = '*';
-            remainingTime[currentProcess]--;
-            time++;
+        if (requiresQuantum(algorithm[0].first) && algorithm[0].second < 1) {
+            cerr << algorithmName(algorithm[0]) << " needs a quantum of at least 1" << endl;
+            return 1;
         }
-        time--; // Adjust for the outer loop increment.
-
-        // If the process is finished, remove it from the queue.
-        if (remainingTime[currentProcess] == 0) {
-            completionTime[currentProcess] = time + 1;
-            turnaroundTime[currentProcess] = completionTime[currentProcess] - extractArrivalTime(processList[currentProcess]);
-            normalizedTurnaround[currentProcess] = (turnaroundTime[currentProcess] * 1.0) / extractServiceTime(processList[currentProcess]);
-            v.erase(v.begin());
+        if (switchCost.enabled()) {
+            cerr << "Switch costs are not modelled on a stream" << endl;
+            return 1;
         }
+        OutputBuffer out(STDOUT_FILENO);
+        runStream(algorithm[0].first, algorithm[0].second, STDIN_FILENO, out, feedback);
+        return 0;
     }
 
-    // Fill in waiting times for the timeline.
-    markWaitingTimes();
-}
+    MetricsClock::time_point startTime = MetricsClock::now();
+    Workload workload = parseInputData();
+    double parseSeconds = secondsSince(startTime);
 
-void runFeedbackQ2i()
-{
-    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> readyQueue; //pair of priority level and process index
-    unordered_map<int,int> remainingTime; //map from process index to the remaining service time
-    int currentIndex = 0;
-    if(extractArrivalTime(processList[0]) == 0) {
-        readyQueue.push({0,currentIndex});
-        remainingTime[currentIndex] = extractServiceTime(processList[currentIndex]);
-        currentIndex++;
-    }
-    for(int time = 0; time < lastMoment; time++) {
-        if(!readyQueue.empty()) {
-            int priorityLevel = readyQueue.top().first;
-            int processIndex =readyQueue.top().second;
-            int arrivalTime = extractArrivalTime(processList[processIndex]);
-            int serviceTime = extractServiceTime(processList[processIndex]);
-            readyQueue.pop();
-            while(currentIndex < processCount && extractArrivalTime(processList[currentIndex]) <= time + 1) {
-                    readyQueue.push({0,currentIndex});
-                    remainingTime[currentIndex] = extractServiceTime(processList[currentIndex]);
-                    currentIndex++;
-            }
+    if (!convertPath.empty()) {
+        writeBinaryWorkload(workload, convertPath);
+        return 0;
+    }
 
-            int quantum = pow(2, priorityLevel);
-            int temp = time;
-            while(quantum && remainingTime[processIndex]){
-                quantum--;
-                remainingTime[processIndex]--;
-                executionTimeline[temp++][processIndex]='*';
-            }
+    bool sweeping = !sweepSpecification.empty();
+    if (sweeping) workload.schedulingAlgorithms = parseSweep(sweepSpecification);
 
-            if(remainingTime[processIndex] == 0) {
-                completionTime[processIndex] = temp;
-                turnaroundTime[processIndex] = (completionTime[processIndex] - arrivalTime);
-                normalizedTurnaround[processIndex] = (turnaroundTime[processIndex] * 1.0 / serviceTime);
-            }else{
-                if(readyQueue.size() >= 1)
-                    readyQueue.push({priorityLevel + 1, processIndex});
-                else
-                    readyQueue.push({priorityLevel, processIndex});
-            }
-            time = temp - 1;
+    for (const pair<char, int>& algorithm : workload.schedulingAlgorithms) {
+        if (algorithm.first < '1' || algorithm.first > '0' + ALGORITHM_COUNT) {
+            cerr << "Invalid algorithm ID, expected 1 to " << ALGORITHM_COUNT << endl;
+            return 1;
         }
-        while(currentIndex < processCount && extractArrivalTime(processList[currentIndex]) <= time + 1) {
-                readyQueue.push({0, currentIndex});
-                remainingTime[currentIndex] = extractServiceTime(processList[currentIndex]);
-                currentIndex++;
+        if (requiresQuantum(algorithm.first) && algorithm.second < 1) {
+            cerr << algorithmName(algorithm) << " needs a quantum of at least 1" << endl;
+            return 1;
+        }
+        if (coreCount > 1 && !supportsMultiCore(algorithm.first)) {
+            cerr << algorithmName(algorithm) << " cannot run on multiple cores" << endl;
+            return 1;
         }
     }
-    markWaitingTimes();
-}
-
-// Print functions
-void printAlgorithm(int index) {
-    cout << SCHEDULING_ALGORITHMS[schedulingAlgorithms[index].first - '0'];
-    if (schedulingAlgorithms[index].second > 0) {
-        cout << "-" << schedulingAlgorithms[index].second;
+    if (coreCount > 1 && switchCost.enabled()) {
+        cerr << "Switch costs are only modelled on a single core" << endl;
+        return 1;
     }
-    cout << endl;
-}
-
-void printProcesses() {
-    cout << "Process    ";
-    for (int i = 0; i < processCount; ++i) {
-        cout << "|  " << extractProcessName(processList[i]) << "  ";
+    if (coreCount > 1 && feedback.customized()) {
+        cerr << "--levels, --quanta and --boost only apply to a single core" << endl;
+        return 1;
     }
-    cout << "|" << endl;
-}
 
-void printArrivalTime()
-{
-    cout << "Arrival    ";
-    for (int i = 0; i < processCount; i++)
-        printf("|%3d  ",extractArrivalTime(processList[i]));
-    cout<<"|\n";
-}
-void printServiceTime()
-{
-    cout << "Service    |";
-    for (int i = 0; i < processCount; i++)
-        printf("%3d  |",extractServiceTime(processList[i]));
-    cout << " Mean|\n";
-}
-void printFinishTime()
-{
-    cout << "Finish     ";
-    for (int i = 0; i < processCount; i++)
-        printf("|%3d  ",completionTime[i]);
-    cout << "|-----|\n";
-}
-void printTurnAroundTime()
-{
-    cout << "Turnaround |";
-    int sum = 0;
-    for (int i = 0; i < processCount; i++)
-    {
-        printf("%3d  |",turnaroundTime[i]);
-        sum += turnaroundTime[i];
+    // Every algorithm runs in its own context over the shared, read-only workload.
+    // Finished runs are printed in input order while later runs are still simulating.
+    int runCount = workload.schedulingAlgorithms.size();
+    bool instrumented = !metricsPath.empty();
+    vector<RunCounters> counters(instrumented ? runCount : 0);
+    vector<unique_ptr<SimulationContext>> contexts(runCount);
+    vector<SweepResult> sweepResults(sweeping ? runCount : 0);
+    bool reportPercentiles = !percentiles.empty() && workload.operationMode == STATS_MODE && !sweeping;
+    vector<unique_ptr<LatencySummary>> latency(reportPercentiles ? runCount : 0);
+    OutputBuffer out(STDOUT_FILENO);
+    auto simulate = [&](SimulationContext& context, int i) {
+        if (coreCount > 1) {
+            runMultiCore(context, workload.schedulingAlgorithms[i].first, workload.schedulingAlgorithms[i].second, coreCount);
+        } else {
+            executeSchedulingAlgorithm(context, workload.schedulingAlgorithms[i].first, workload.schedulingAlgorithms[i].second);
+        }
+    };
+
+    // Each replica draws its workload from its own seed and runs every algorithm on it. Replicas are
+    // summarized in replica order once all have finished, so the output does not depend on the threads.
+    if (replicaCount > 0) {
+        WorkloadShape shape = fitWorkloadShape(workload);
+        vector<vector<ReplicaMetrics>> metrics(replicaCount, vector<ReplicaMetrics>(runCount));
+        runInParallel(replicaCount, [&](int r) {
+            Workload replica = generateWorkload(workload.processCount, shape, replicaSeed(seed, r));
+            thread_local SchedulerArena arena;
+            for (int i = 0; i < runCount; ++i) {
+                SimulationContext context(replica, false);
+                context.arena = &arena;
+                context.feedback = feedback;
+                context.switchCosts.model = switchCost;
+                simulate(context, i);
+                metrics[r][i] = measureReplica(context);
+            }
+        }, nullptr, threadCount);
+        printReplicaSummary(workload, shape, seed, metrics, out);
+        return 0;
     }
-    if((1.0 * sum / turnaroundTime.size())>=10)
-        printf("%2.2f|\n",(1.0 * sum / turnaroundTime.size()));
-    else
-        printf(" %2.2f|\n",(1.0 * sum / turnaroundTime.size()));
-}
 
-void printNormTurn()
-{
-    cout << "NormTurn   |";
-    float sum = 0;
-    for (int i = 0; i < processCount; i++)
-    {
-        if( normalizedTurnaround[i]>=10 )
-            printf("%2.2f|",normalizedTurnaround[i]);
-        else
-            printf(" %2.2f|",normalizedTurnaround[i]);
-        sum += normalizedTurnaround[i];
+    unique_ptr<ChromeTraceFile> chromeTrace;
+    if (!chromeTracePath.empty()) {
+        chromeTrace = make_unique<ChromeTraceFile>(chromeTracePath);
+        if (!chromeTrace->isOpen()) {
+            cerr << "Cannot write the trace to " << chromeTracePath << endl;
+            return 1;
+        }
     }
 
-    if( (1.0 * sum / normalizedTurnaround.size()) >=10 )
-        printf("%2.2f|\n",(1.0 * sum / normalizedTurnaround.size()));
-    else
-        printf(" %2.2f|\n",(1.0 * sum / normalizedTurnaround.size()));
-}
-
-void printStats(int index) {
-    printAlgorithm(index);
-    printProcesses();
-    printArrivalTime();
-    printServiceTime();
-    printFinishTime();
-    printTurnAroundTime();
-    printNormTurn();
-}
+    // Each worker thread reuses one arena for the scheduler storage of all the runs it takes
+    if (sweeping) printSweepHeader(switchCost.enabled(), out);
+    runInParallel(runCount, [&](int i) {
+        thread_local SchedulerArena arena;
+        contexts[i] = make_unique<SimulationContext>(workload, workload.operationMode == TRACE_MODE && !sweeping);
+        contexts[i]->arena = &arena;
+        contexts[i]->feedback = feedback;
+        contexts[i]->switchCosts.model = switchCost;
+        unique_ptr<ChromeTraceWriter> traceWriter;
+        if (chromeTrace) {
+            traceWriter = make_unique<ChromeTraceWriter>(*chromeTrace, workload, i, algorithmName(workload.schedulingAlgorithms[i]), coreCount);
+            contexts[i]->chromeTrace = traceWriter.get();
+        }
+        if (!instrumented) {
+            simulate(*contexts[i], i);
+        } else {
+            contexts[i]->counters = &counters[i];
+            MetricsClock::time_point simulateStart = MetricsClock::now();
+            simulate(*contexts[i], i);
+            counters[i].simulateSeconds = secondsSince(simulateStart);
+        }
 
-void printTimeline(int index) {
-    for (int i = 0; i <= lastMoment; i++)
-        cout << i % 10<<" ";
-    cout <<"\n";
-    cout << "------------------------------------------------\n";
-    for (int i = 0; i < processCount; i++)
-    {
-        cout << extractProcessName(processList[i]) << "     |";
-        for (int j = 0; j < lastMoment; j++)
-        {
-            cout << executionTimeline[j][i]<<"|";
+        if (traceWriter) {
+            traceWriter->finish();
+            contexts[i]->chromeTrace = nullptr;
         }
-        cout << " \n";
-    }
-    cout << "------------------------------------------------\n";
-}
+        if (reportPercentiles) latency[i] = summarizeLatency(*contexts[i]);
 
-void executeSchedulingAlgorithm(char algorithmId, int quantum, const string& mode) {
-    switch (algorithmId)
-    {
-    case '1':
-        if(mode == TRACE_MODE)cout<<"FCFS  ";
-        runFCFS();
-        break;
-    case '2':
-        if(mode == TRACE_MODE) cout << "RR-" << quantum << "  ";
-        runRoundRobin(quantum);
-        break;
-    case '3':
-        if(mode == TRACE_MODE) cout << "SPN   ";
-        runSPN();
-        break;
-    case '4':
-        if(mode == TRACE_MODE) cout << "SRT   ";
-        runSRT();
-        break;
-    case '5':
-        if(mode == TRACE_MODE) cout << "HRRN  ";
-        runHRRN();
-        break;
-    case '6':
-        if(mode == TRACE_MODE) cout << "FB-1  ";
-        runFeedbackQ1();
-        break;
-    case '7':
-        if(mode == TRACE_MODE) cout << "FB-2i ";
-        runFeedbackQ2i();
-        break;
-    case '8':
-        if(mode == TRACE_MODE) cout << "Aging ";
-        runAging(quantum);
-        break;
-    default:
-        cerr << "Invalid algorithm ID!" << endl;
-        break;
+        // A sweep keeps only the means, so memory stays flat however many configurations run
+        if (sweeping) {
+            sweepResults[i] = summarizeRun(*contexts[i]);
+            contexts[i].reset();
+        }
+    }, [&](int i) {
+        MetricsClock::time_point printStart = MetricsClock::now();
+        if (sweeping) {
+            printSweepRow(workload, i, sweepResults[i], switchCost.enabled(), out);
+            if (instrumented) counters[i].printSeconds = secondsSince(printStart);
+            return;
+        }
+        if (workload.operationMode == TRACE_MODE) {
+            printTimeline(*contexts[i], i, out);
+        } else if (workload.operationMode == STATS_MODE) {
+            printStats(*contexts[i], i, out);
+            if (switchCost.enabled()) printSwitchCosts(*contexts[i], out);
+            if (reportPercentiles) {
+                printPercentiles(*latency[i], percentiles, out);
+                latency[i].reset();
+            }
+        }
+        if (coreCount > 1) printCoreUsage(*contexts[i], out);
+
+        out.write('\n');
+        contexts[i].reset();
+        if (instrumented) counters[i].printSeconds = secondsSince(printStart);
+    }, threadCount);
+    if (sweeping) printSweepBest(workload, sweepResults, out);
+    out.flush();
+
+    if (chromeTrace && !chromeTrace->close()) {
+        cerr << "Cannot write the trace to " << chromeTracePath << endl;
+        return 1;
     }
-}
 
-int main() {
-    parseInputData();
-    for (int i = 0; i < schedulingAlgorithms.size(); ++i) {
-        resetTimeline();
-        executeSchedulingAlgorithm(schedulingAlgorithms[i].first, schedulingAlgorithms[i].second, operationMode);
-    
-        if (operationMode == TRACE_MODE) {
-            printTimeline(i);
-        } else if (operationMode == STATS_MODE) {
-            printStats(i);
+    if (instrumented) {
+        vector<string> labels;
+        for (const pair<char, int>& algorithm : workload.schedulingAlgorithms) labels.push_back(algorithmName(algorithm));
+        if (!writeMetricsJson(metricsPath, parseSeconds, secondsSince(startTime), labels, counters)) {
+            cerr << "Cannot write metrics to " << metricsPath << endl;
+            return 1;
         }
-
-        cout << endl;
     }
+
     return 0;
 }
\ No newline at end of file
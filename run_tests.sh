@@ -0,0 +1,103 @@
+#!/bin/bash
+# Builds the simulator and checks.cpp, then runs the testcases and the randomized checks,
+# the latter once more under ThreadSanitizer.
+# Usage: ./run_tests.sh [build directory]
+
+cd "$(dirname "$0")" || exit 1
+build=${1:-/tmp/scheduler-tests}
+mkdir -p "$build" || exit 1
+failed=0
+
+fail() {
+    echo "FAIL: $*"
+    failed=1
+}
+
+g++ -O2 -std=c++17 -Wall -Wextra -pthread -o "$build/main" main.cpp || exit 1
+g++ -O2 -std=c++17 -Wall -Wextra -pthread -o "$build/checks" checks.cpp || exit 1
+g++ -O1 -g -std=c++17 -pthread -fsanitize=thread -o "$build/checks-tsan" checks.cpp || exit 1
+main=$build/main
+
+# Expected outputs have CRLF line endings and no trailing blanks
+for input in testcases/*-input.txt; do
+    expected=${input%-input.txt}-output.txt
+    if ! diff -q <(sed -e 's/\r$//' -e 's/ *$//' -e '$a\' "$expected") <("$main" < "$input" | sed -e 's/ *$//' | sed -e '$ { /^$/d }') > /dev/null; then
+        fail "$input"
+    fi
+done
+
+# The binary format reproduces the text workload, and a truncated file is rejected
+"$main" --convert "$build/workload.bin" < testcases/01a-input.txt || fail "--convert"
+cmp -s <("$main" < testcases/01a-input.txt) <("$main" < "$build/workload.bin") || fail "binary workload output differs"
+head -c 40 "$build/workload.bin" > "$build/truncated.bin"
+"$main" < "$build/truncated.bin" 2>&1 | grep -q "Truncated/corrupt workload file" || fail "truncated binary workload accepted"
+
+# Algorithm IDs outside 1..11 are rejected rather than indexing past the algorithm names
+for algorithms in 0 12 x 1,12; do
+    printf 'trace\n%s\n20\n1\nA,0,3\n' "$algorithms" | timeout 5 "$main" > /dev/null 2>&1 && fail "algorithm $algorithms accepted"
+done
+
+# RR and Aging without a positive quantum are rejected rather than spinning forever
+for algorithms in 2 2-0 8; do
+    printf 'trace\n%s\n20\n1\nA,0,3\n' "$algorithms" | timeout 5 "$main" > /dev/null 2>&1 && fail "quantum of $algorithms accepted"
+done
+timeout 5 "$main" --sweep 2 < testcases/01a-input.txt > /dev/null 2>&1 && fail "--sweep 2 accepted"
+echo "A,0,3" | timeout 5 "$main" --stream 2 > /dev/null 2>&1 && fail "--stream 2 accepted"
+
+# A stream finishes every job when the batch run does; switch costs are not modelled there
+workload='A,0,3\nB,2,6\nC,4,4\nD,6,5\nE,8,2\nF,8,7\nG,15,1\nH,30,4'
+for algorithm in 1 2-1 2-4 3 4 6 7; do
+    batch=$(printf "statistics\n%s\n100\n8\n$workload\n" "$algorithm" | "$main" | awk -F'|' '/^Finish/ { for (i = 2; i < NF - 1; i++) print $i + 0 }')
+    stream=$(printf "$workload\n" | "$main" --stream "$algorithm" | tail -n +2 | sort | cut -d, -f4)
+    [ -n "$batch" ] && [ "$batch" = "$stream" ] || fail "--stream $algorithm differs from the batch run"
+done
+echo "A,0,3" | timeout 5 "$main" --stream 1 --switch-cost 1 > /dev/null 2>&1 && fail "--stream with --switch-cost accepted"
+
+# A sweep prints one row per configuration and the best quantum of each algorithm
+cmp -s <("$main" --sweep 1,2-1..4 < testcases/01a-input.txt) - << 'END' || fail "--sweep output"
+Sweep       |  Turnaround |    NormTurn |  Unfinished |
+FCFS        |        8.60 |        2.56 |           0 |
+RR-1        |       10.80 |        2.71 |           0 |
+RR-2        |       10.00 |        2.54 |           0 |
+RR-3        |       10.60 |        2.79 |           0 |
+RR-4        |       10.00 |        2.71 |           0 |
+Best FCFS: FCFS (turnaround 8.60), FCFS (normturn 2.56)
+Best RR: RR-2 (turnaround 10.00), RR-2 (normturn 2.54)
+END
+
+# Percentiles leave out processes that did not finish and count them instead
+cmp -s <(printf 'statistics\n1\n5\n3\nA,0,3\nB,0,10\nC,1,10\n' | "$main" --percentiles 50,90 | tail -n 6) - << 'END' || fail "--percentiles with unfinished processes"
+Percentile |    p50|    p90|    max|
+Turnaround |      3|      3|      3|
+Waiting    |      0|      0|      0|
+NormTurn   |   1.00|   1.00|   1.00|
+Unfinished | 2
+
+END
+
+# Metrics of a small two-core run with the timings zeroed; the counters are summed over the cores
+printf 'trace\n1,2-1\n20\n4\nA,0,3\nB,0,2\nC,1,4\nD,2,1\n' | "$main" --cores 2 --metrics "$build/metrics.json" > /dev/null || fail "--metrics"
+cmp -s <(sed -E 's/"([a-z_]+seconds)": [0-9.]+/"\1": 0/g' "$build/metrics.json") - << 'END' || fail "--metrics output"
+{
+  "parse_seconds": 0,
+  "total_seconds": 0,
+  "runs": [
+    {"algorithm": "FCFS", "simulate_seconds": 0, "print_seconds": 0, "dispatches": 4, "context_switches": 4, "queue_pushes": 4, "queue_pops": 4, "max_queue_depth": 1, "mean_queue_depth": 1.000},
+    {"algorithm": "RR-1", "simulate_seconds": 0, "print_seconds": 0, "dispatches": 10, "context_switches": 7, "queue_pushes": 10, "queue_pops": 10, "max_queue_depth": 2, "mean_queue_depth": 1.300}
+  ]
+}
+END
+
+# Replicas do not depend on the number of threads
+cmp -s <("$main" --replicas 8 --threads 1 < testcases/01a-input.txt) <("$main" --replicas 8 --threads 4 < testcases/01a-input.txt) ||
+    fail "--replicas output depends on --threads"
+
+# Every run lands in one JSON array, multi-core runs included
+"$main" --chrome-trace "$build/trace.json" --cores 2 < testcases/01a-input.txt > /dev/null || fail "--chrome-trace"
+[ "$(head -c 1 "$build/trace.json")" = "[" ] && [ "$(tail -n 1 "$build/trace.json")" = "]" ] || fail "--chrome-trace is not a JSON array"
+
+"$build/checks" || fail "checks"
+"$build/checks-tsan" || fail "checks under ThreadSanitizer"
+
+[ $failed = 0 ] && echo "All tests passed"
+exit $failed
@@ -0,0 +1,1373 @@
+#ifndef SCHEDULER_ALGORITHMS_H
+#define SCHEDULER_ALGORITHMS_H
+
+#include <bits/stdc++.h>
+#include "scheduler_parser.h"
+#include "scheduler_metrics.h"
+#include "scheduler_chrome_trace.h"
+
+using namespace std;
+
+/** Header for the scheduling algorithms and the per-run simulation context **/
+
+inline const string SCHEDULING_ALGORITHMS[12] = {"", "FCFS", "RR", "SPN", "SRT", "HRRN", "FB-1", "FB-2i", "AGING", "CFS", "STRIDE", "LOTTERY"};
+inline const int ALGORITHM_COUNT = 11;
+
+// Algorithm IDs are stored as '0' + number, so the ones past 9 are not digits
+inline const char CFS_ID = '9';
+inline const char STRIDE_ID = '0' + 10;
+inline const char LOTTERY_ID = '0' + 11;
+
+// A contiguous interval [start, end) during which a process held the CPU
+struct RunSegment {
+    int start;
+    int end;
+};
+
+// Work done by one CPU of a multi-core run
+struct CoreUsage {
+    long long busyTime = 0;
+    long long dispatches = 0;
+    long long steals = 0; // Ready processes this core took from another core's queue
+};
+
+// Shape of the feedback queues. The defaults reproduce FB-1 and FB-2i.
+struct FeedbackConfig {
+    int levelCount = 0;        // Number of levels, 0 for as many as needed
+    vector<long long> quanta;  // Quantum of each level, the last one repeating below; empty for the policy's own
+    long long boostPeriod = 0; // Move every waiting process back to the top level this often, 0 for never
+
+    bool customized() const { return levelCount > 0 || !quanta.empty() || boostPeriod > 0; }
+};
+
+/*
+ * Cost of handing the CPU to a different process: a fixed dispatch overhead
+ * plus a warm-up penalty for refilling caches and TLBs, which grows linearly
+ * with the time the process spent off the CPU until it is fully cold.
+ * A process that has not run yet is cold. With the default model switching is free.
+ */
+struct SwitchCostModel {
+    long long switchCost = 0; // Dispatch overhead of every switch
+    long long warmupCost = 0; // Penalty of a fully cold process
+    long long coldAfter = 0;  // Time off the CPU after which a process is fully cold, 0 for at once
+
+    bool enabled() const { return switchCost > 0 || warmupCost > 0; }
+};
+
+// CPU time a run lost to switching, and what the model needs to price the next switch
+struct SwitchCosts {
+    SwitchCostModel model;
+    long long switches = 0;
+    long long lostTime = 0;
+    int lastProcess = -1;
+    vector<long long> offCpuSince; // End of each process's last slice, -1 before its first one
+};
+
+/*
+ * State of a run at a scheduling point, from which a run over an edited
+ * workload can continue instead of starting again at time 0.
+ * Only the admitted processes are stored, so a snapshot costs memory in
+ * proportion to the processes that had arrived by then.
+ */
+struct SchedulerSnapshot {
+    long long time = 0;        // Scheduling point the state was taken at
+    int admitted = 0;          // Processes that had arrived by then
+    uint64_t fingerprint = 0;  // Of the arrival and service times of the admitted processes
+    any state;                 // The scheduler's own: ready queue, remaining times, levels, aging offset
+    SwitchCosts switchCosts;   // Switch accounting so far, offCpuSince only for the admitted processes
+    vector<int> completionTime; // Results of the admitted processes so far
+    vector<int> turnaroundTime;
+    vector<float> normalizedTurnaround;
+    vector<vector<RunSegment>> executionSegments; // Empty unless the run recorded its timeline
+};
+
+inline const uint64_t FINGERPRINT_SEED = 14695981039346656037ULL;
+
+// Snapshots a run takes, and the one it continues from
+struct SnapshotPlan {
+    vector<long long> times; // Ascending; one snapshot at the first scheduling point at or after each
+    vector<SchedulerSnapshot> taken;
+    const SchedulerSnapshot* resumeFrom = nullptr;
+    size_t nextTime = 0;
+    int fingerprinted = 0; // Processes folded into fingerprint so far
+    uint64_t fingerprint = FINGERPRINT_SEED;
+};
+
+struct SchedulerArena;
+
+/*
+ * Results and timeline of a single scheduling run.
+ * Each run owns its context, so runs over the same workload are independent.
+ * Without a timeline only the per-process results are kept, which is all the
+ * statistics output needs.
+ */
+struct SimulationContext {
+    const Workload& workload;
+    vector<int> completionTime;
+    vector<int> turnaroundTime;
+    vector<float> normalizedTurnaround;
+    vector<vector<RunSegment>> executionSegments; // Run intervals of each process, in time order, if recorded
+    bool recordTimeline;
+    RunCounters* counters = nullptr;              // Instrumentation of the run, null when disabled
+    ChromeTraceWriter* chromeTrace = nullptr;     // Trace-event export of the run, null when disabled
+    FeedbackConfig feedback;                      // Queue shape of FB-1 and FB-2i
+    SnapshotPlan* snapshots = nullptr;            // Snapshots to take and to resume from, null when unused
+    SchedulerArena* arena = nullptr;              // Scheduler storage reused across runs, null to allocate per run
+    SwitchCosts switchCosts;                      // Switch cost model and the time it cost, single-core runs only
+    vector<CoreUsage> coreUsage;                  // One entry per CPU, empty for single-core runs
+    long long migrations = 0;                     // Dispatches on a different CPU than the previous one
+    long long makespan = 0;                       // End of the last run slice of a multi-core run
+
+    explicit SimulationContext(const Workload& workload, bool recordTimeline = true)
+        : workload(workload), completionTime(workload.processCount), turnaroundTime(workload.processCount),
+          normalizedTurnaround(workload.processCount), executionSegments(recordTimeline ? workload.processCount : 0), recordTimeline(recordTimeline) {}
+};
+
+/*
+ * Entry of the Aging ready queue.
+ * Each decision ages every waiting process by one, so rather than touching all
+ * of them the queue keeps the number of decisions made so far as a global
+ * offset. A process whose wait counter was zero at decision `base` has waited
+ * (decisions - base) rounds and has priority (initial - base) + decisions.
+ * Only the selected process, which does not age, ever changes its key.
+ */
+struct AgingEntry {
+    long long relativePriority; // Initial priority - base
+    long long base;             // Decision count at which the wait counter was zero
+    long long lastSelected;     // Decision that last selected the process, -1 if none
+    int processIndex;
+};
+
+// Highest priority first, then longest wait. Remaining ties keep the previous order:
+// the most recently selected process first, otherwise the earlier process.
+struct CompareByAgedPriority {
+    bool operator()(const AgingEntry& a, const AgingEntry& b) const {
+        if (a.relativePriority != b.relativePriority) return a.relativePriority < b.relativePriority;
+        if (a.base != b.base) return a.base > b.base;
+        if (a.lastSelected != b.lastSelected) return a.lastSelected < b.lastSelected;
+        return a.processIndex > b.processIndex;
+    }
+};
+
+// priority_queue that can be built on a borrowed, empty buffer and hand it back afterwards
+template <class T, class Compare>
+struct ReusableHeap : priority_queue<T, vector<T>, Compare> {
+    ReusableHeap() = default;
+    explicit ReusableHeap(vector<T> storage) : priority_queue<T, vector<T>, Compare>(Compare(), move(storage)) {}
+
+    vector<T> release() {
+        this->c.clear();
+        return move(this->c);
+    }
+};
+
+using AgingReadyQueue = ReusableHeap<AgingEntry, CompareByAgedPriority>;
+
+/*
+ * Event helpers shared by all schedulers.
+ * The simulation clock only ever moves to the next arrival, quantum expiry
+ * or completion, so every run below costs time proportional to the number
+ * of scheduling events rather than to lastMoment.
+ */
+
+// Record the interval [start, end) as executed by a process.
+// Back-to-back slices of the same process are merged into one segment.
+inline void recordRun(SimulationContext& context, int processIndex, int start, int end, int core = 0) {
+    if (context.counters) {
+        context.counters->dispatches++;
+        vector<int>& lastProcess = context.counters->lastProcess;
+        if ((int)lastProcess.size() <= core) lastProcess.resize(core + 1, -1);
+        context.counters->contextSwitches += lastProcess[core] != processIndex;
+        lastProcess[core] = processIndex;
+    }
+    if (context.switchCosts.model.enabled()) {
+        context.switchCosts.lastProcess = processIndex;
+        context.switchCosts.offCpuSince[processIndex] = end;
+    }
+    if (context.chromeTrace) context.chromeTrace->slice(processIndex, core, start, end);
+    if (!context.recordTimeline) return;
+
+    vector<RunSegment>& segments = context.executionSegments[processIndex];
+    if (!segments.empty() && segments.back().end == start) {
+        segments.back().end = end;
+    } else {
+        segments.push_back({start, end});
+    }
+}
+
+// Ready-queue instrumentation: depth is the queue size when a process is selected, including it
+inline void countPush(SimulationContext& context) {
+    if (context.counters) context.counters->queuePushes++;
+}
+
+inline void countPop(SimulationContext& context, long long depth) {
+    if (context.counters) {
+        context.counters->queuePops++;
+        context.counters->queueDepthSum += depth;
+        context.counters->maxQueueDepth = max(context.counters->maxQueueDepth, depth);
+    }
+}
+
+// Store finish, turnaround and normalized turnaround of a completed process
+inline void recordCompletion(SimulationContext& context, int processIndex, int finishTime) {
+    const Workload& workload = context.workload;
+    context.completionTime[processIndex] = finishTime;
+    context.turnaroundTime[processIndex] = finishTime - workload.arrival[processIndex];
+    context.normalizedTurnaround[processIndex] = (context.turnaroundTime[processIndex] * 1.0) / workload.service[processIndex];
+    if (context.chromeTrace) context.chromeTrace->completed(processIndex);
+}
+
+/*
+ * Time the CPU spends switching to processIndex at time before it can run,
+ * counted as lost. Re-dispatching the process that ran last costs nothing.
+ */
+inline long long dispatchOverhead(SimulationContext& context, int processIndex, long long time) {
+    SwitchCosts& costs = context.switchCosts;
+    if (!costs.model.enabled() || costs.lastProcess == processIndex) return 0;
+    if (costs.offCpuSince.empty()) costs.offCpuSince.assign(context.workload.processCount, -1);
+
+    long long offCpu = costs.offCpuSince[processIndex] < 0 ? LLONG_MAX : time - costs.offCpuSince[processIndex];
+    long long warmup = costs.model.warmupCost;
+    if (offCpu < costs.model.coldAfter) warmup = warmup * offCpu / costs.model.coldAfter;
+    long long overhead = min(costs.model.switchCost + warmup, (long long)context.workload.lastMoment - time);
+
+    costs.switches++;
+    costs.lostTime += overhead;
+    costs.lastProcess = processIndex;
+    if (context.chromeTrace && overhead > 0) context.chromeTrace->switchOverhead(processIndex, time, overhead);
+    return overhead;
+}
+
+// Arrival time of the next process that has not entered the ready queue yet
+inline int nextArrivalTime(const Workload& workload, int currentIndex) {
+    return currentIndex < workload.processCount ? workload.arrival[currentIndex] : INT_MAX;
+}
+
+/*
+ * Snapshot helpers.
+ * A scheduler takes snapshots at the top of its loop, once the arrivals up to
+ * the current time are queued, and resumes by restoring the results so far and
+ * its own state. A run's decisions up to a snapshot depend only on the admitted
+ * processes, the next arrival and lastMoment, which is what snapshotFits checks.
+ */
+
+// Fold processes [from, to) into a running fingerprint of what the schedulers read
+inline uint64_t extendFingerprint(uint64_t fingerprint, const Workload& workload, int from, int to) {
+    for (int i = from; i < to; ++i) {
+        fingerprint = (fingerprint ^ (uint32_t)workload.arrival[i]) * 1099511628211ULL;
+        fingerprint = (fingerprint ^ (uint32_t)workload.service[i]) * 1099511628211ULL;
+    }
+    return fingerprint;
+}
+
+// Whether a run over workload, whose first snapshot.admitted processes have the given fingerprint,
+// makes the same decisions as the snapshotted run up to the snapshot: nothing else may arrive by then.
+// Slices are never cut by an arrival that has not happened yet, and a lone process granted several
+// quanta at once runs exactly as it would one quantum at a time, so later arrivals cannot matter.
+inline bool snapshotFits(const SchedulerSnapshot& snapshot, const Workload& workload, uint64_t prefixFingerprint) {
+    if (snapshot.admitted > workload.processCount || prefixFingerprint != snapshot.fingerprint) return false;
+    return nextArrivalTime(workload, snapshot.admitted) > snapshot.time && workload.lastMoment > snapshot.time;
+}
+
+inline bool snapshotDue(const SimulationContext& context, long long time) {
+    const SnapshotPlan* plan = context.snapshots;
+    return plan && plan->nextTime < plan->times.size() && plan->times[plan->nextTime] <= time;
+}
+
+template <class State>
+void takeSnapshot(SimulationContext& context, long long time, int admitted, State state) {
+    SnapshotPlan& plan = *context.snapshots;
+    while (plan.nextTime < plan.times.size() && plan.times[plan.nextTime] <= time) plan.nextTime++;
+    plan.fingerprint = extendFingerprint(plan.fingerprint, context.workload, plan.fingerprinted, admitted);
+    plan.fingerprinted = admitted;
+
+    SchedulerSnapshot snapshot;
+    snapshot.time = time;
+    snapshot.admitted = admitted;
+    snapshot.fingerprint = plan.fingerprint;
+    snapshot.state = move(state);
+    snapshot.switchCosts = context.switchCosts;
+    if (!snapshot.switchCosts.offCpuSince.empty()) snapshot.switchCosts.offCpuSince.resize(admitted);
+    snapshot.completionTime.assign(context.completionTime.begin(), context.completionTime.begin() + admitted);
+    snapshot.turnaroundTime.assign(context.turnaroundTime.begin(), context.turnaroundTime.begin() + admitted);
+    snapshot.normalizedTurnaround.assign(context.normalizedTurnaround.begin(), context.normalizedTurnaround.begin() + admitted);
+    if (context.recordTimeline) {
+        snapshot.executionSegments.assign(context.executionSegments.begin(), context.executionSegments.begin() + admitted);
+    }
+    plan.taken.push_back(move(snapshot));
+}
+
+// Restore the results of the snapshot the run continues from and return the scheduler's saved state,
+// or null (leaving everything untouched) if there is none
+template <class State>
+const State* resumeSnapshot(SimulationContext& context, long long& time, int& admitted) {
+    if (!context.snapshots || !context.snapshots->resumeFrom) return nullptr;
+    SnapshotPlan& plan = *context.snapshots;
+    const SchedulerSnapshot& snapshot = *plan.resumeFrom;
+    const State* state = any_cast<State>(&snapshot.state);
+    if (!state) return nullptr;
+
+    time = snapshot.time;
+    admitted = snapshot.admitted;
+    copy(snapshot.completionTime.begin(), snapshot.completionTime.end(), context.completionTime.begin());
+    copy(snapshot.turnaroundTime.begin(), snapshot.turnaroundTime.end(), context.turnaroundTime.begin());
+    copy(snapshot.normalizedTurnaround.begin(), snapshot.normalizedTurnaround.end(), context.normalizedTurnaround.begin());
+    if (context.recordTimeline) {
+        copy(snapshot.executionSegments.begin(), snapshot.executionSegments.end(), context.executionSegments.begin());
+    }
+    context.switchCosts = snapshot.switchCosts;
+    if (!context.switchCosts.offCpuSince.empty()) context.switchCosts.offCpuSince.resize(context.workload.processCount, -1);
+    plan.fingerprint = snapshot.fingerprint;
+    plan.fingerprinted = snapshot.admitted;
+    return state;
+}
+
+/*
+ * Policies composed at compile time.
+ * FCFS, RR, SPN, SRT and the feedback policies share one event loop and only
+ * differ in four components, each a small type whose calls inline into the
+ * loop when runComposedPolicy is instantiated:
+ *   ready queue  - which waiting process is dispatched next
+ *   quantum      - the time slice granted at a feedback level
+ *   preemption   - what else ends a slice early
+ *   level rule   - how the feedback level changes after a slice
+ * A new policy is a new combination, e.g. feedback with 3^i quanta is
+ * GeometricQuantum<3> with the FB-2i components. Every slice ends at lastMoment.
+ * HRRN and Aging order processes by how long they have waited, which these
+ * components cannot express cheaply, so they keep their own loops below.
+ * The loop reads arrivals from and reports runs to a feed, so the same
+ * policies drive both a loaded workload and a stream of jobs.
+ */
+
+// A process waiting in a composed policy's ready queue
+struct ReadyProcess {
+    int processIndex; // Arrival order, which also breaks ties between equal keys
+    int serviceTime;
+    int remainingTime;
+    int level; // Feedback level, 0 for policies without levels
+};
+
+// Ready queues: first come first served, or smallest key first with ties to the earlier process.
+// advanceTo lets a queue react to the clock before each dispatch.
+// A queue can be built on storage borrowed from a SchedulerArena and hands it back with release().
+
+// Ring buffer whose size is a power of two, doubled when it is full.
+// Copies (snapshots) only hold the waiting processes.
+class FifoReadyQueue {
+public:
+    FifoReadyQueue() = default;
+    explicit FifoReadyQueue(vector<ReadyProcess> storage) : ring(move(storage)) {}
+
+    FifoReadyQueue(const FifoReadyQueue& other) : ring(ringSizeFor(other.count)), count(other.count) {
+        for (size_t i = 0; i < count; ++i) ring[i] = other.at(i);
+    }
+
+    FifoReadyQueue(FifoReadyQueue&&) = default;
+
+    FifoReadyQueue& operator=(FifoReadyQueue other) {
+        swap(ring, other.ring);
+        head = other.head;
+        count = other.count;
+        return *this;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    void advanceTo(long long) {}
+
+    void push(const ReadyProcess& process) {
+        if (count == ring.size()) grow();
+        ring[(head + count) & (ring.size() - 1)] = process;
+        count++;
+    }
+
+    ReadyProcess pop() {
+        ReadyProcess next = ring[head];
+        head = (head + 1) & (ring.size() - 1);
+        count--;
+        return next;
+    }
+
+    vector<ReadyProcess> release() {
+        head = count = 0;
+        return move(ring);
+    }
+
+    static size_t ringSizeFor(size_t processes) {
+        size_t size = 16;
+        while (size < processes) size *= 2;
+        return size;
+    }
+
+private:
+    vector<ReadyProcess> ring;
+    size_t head = 0;
+    size_t count = 0;
+
+    const ReadyProcess& at(size_t i) const { return ring[(head + i) & (ring.size() - 1)]; }
+
+    void grow() {
+        vector<ReadyProcess> larger(ringSizeFor(ring.size() + 1));
+        for (size_t i = 0; i < count; ++i) larger[i] = at(i);
+        ring = move(larger);
+        head = 0;
+    }
+};
+
+struct KeyByServiceTime {
+    static int key(const ReadyProcess& process) { return process.serviceTime; }
+};
+
+struct KeyByRemainingTime {
+    static int key(const ReadyProcess& process) { return process.remainingTime; }
+};
+
+struct KeyedEntry {
+    int key;
+    ReadyProcess process;
+
+    bool operator>(const KeyedEntry& other) const {
+        return key != other.key ? key > other.key : process.processIndex > other.process.processIndex;
+    }
+};
+
+template <class Key>
+struct KeyedReadyQueue {
+    ReusableHeap<KeyedEntry, greater<KeyedEntry>> entries;
+
+    KeyedReadyQueue() = default;
+    explicit KeyedReadyQueue(vector<KeyedEntry> storage) : entries(move(storage)) {}
+
+    bool empty() const { return entries.empty(); }
+    size_t size() const { return entries.size(); }
+    void push(const ReadyProcess& process) { entries.push({Key::key(process), process}); }
+    void advanceTo(long long) {}
+
+    ReadyProcess pop() {
+        ReadyProcess next = entries.top().process;
+        entries.pop();
+        return next;
+    }
+
+    vector<KeyedEntry> release() { return entries.release(); }
+};
+
+/*
+ * Set of levels as a tree of 64-bit words: each bit of a layer says whether
+ * the word below it has any bit set. Finding the smallest level takes one
+ * count-trailing-zeros per layer, so it is constant time for a given depth.
+ * The tree grows as higher levels are used.
+ */
+class LevelBitmap {
+public:
+    LevelBitmap() : layers(1, vector<uint64_t>(1, 0)) {}
+
+    bool empty() const { return layers.back()[0] == 0; }
+
+    void insert(int level) {
+        if (level >= capacity()) grow(level);
+        for (vector<uint64_t>& layer : layers) {
+            layer[level >> 6] |= 1ULL << (level & 63);
+            level >>= 6;
+        }
+    }
+
+    void erase(int level) {
+        for (vector<uint64_t>& layer : layers) {
+            layer[level >> 6] &= ~(1ULL << (level & 63));
+            if (layer[level >> 6] != 0) break;
+            level >>= 6;
+        }
+    }
+
+    // Smallest level in the set, -1 if it is empty
+    int first() const {
+        if (empty()) return -1;
+        int index = 0;
+        for (int layer = layers.size() - 1; layer >= 0; --layer) {
+            index = index * 64 + __builtin_ctzll(layers[layer][index]);
+        }
+        return index;
+    }
+
+private:
+    vector<vector<uint64_t>> layers; // layers[0] holds one bit per level, the last layer a single word
+
+    long long capacity() const { return 64LL * layers[0].size(); }
+
+    void grow(int level) {
+        vector<uint64_t> levels = move(layers[0]);
+        levels.resize(max<size_t>(levels.size() * 2, level / 64 + 1), 0);
+        layers.clear();
+        layers.push_back(move(levels));
+        while (layers.back().size() > 1) {
+            const vector<uint64_t>& below = layers.back();
+            vector<uint64_t> above((below.size() + 63) / 64, 0);
+            for (size_t word = 0; word < below.size(); ++word) {
+                if (below[word]) above[word >> 6] |= 1ULL << (word & 63);
+            }
+            layers.push_back(move(above));
+        }
+    }
+};
+
+/*
+ * Multilevel feedback ready queue: one FIFO per level and a bitmap of the
+ * non-empty levels, so push and pop are O(1). The FIFOs are linked lists
+ * threaded through a pool of nodes that is reused as processes leave.
+ * Levels below the last one are clamped to it. With a boost period, the
+ * first dispatch at or after each multiple of the period moves every waiting
+ * process to level 0, keeping their order.
+ */
+class MultilevelReadyQueue {
+public:
+    struct Node {
+        ReadyProcess process;
+        int next;
+    };
+
+    struct Level {
+        int head = -1;
+        int tail = -1;
+    };
+
+    // Buffers of an empty queue, kept between runs
+    struct Storage {
+        vector<Node> nodes;
+        vector<int> freeNodes;
+        vector<Level> levels;
+        LevelBitmap occupied;
+    };
+
+    explicit MultilevelReadyQueue(const FeedbackConfig& config, Storage storage = Storage())
+        : lastLevel(config.levelCount > 0 ? config.levelCount - 1 : INT_MAX - 1), boostPeriod(config.boostPeriod), nextBoost(config.boostPeriod),
+          nodes(move(storage.nodes)), freeNodes(move(storage.freeNodes)), levels(move(storage.levels)), occupied(move(storage.occupied)) {}
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void push(ReadyProcess process) {
+        process.level = min(process.level, lastLevel);
+        int node;
+        if (freeNodes.empty()) {
+            node = nodes.size();
+            nodes.push_back({process, -1});
+        } else {
+            node = freeNodes.back();
+            freeNodes.pop_back();
+            nodes[node] = {process, -1};
+        }
+        append(process.level, node, node);
+        count++;
+    }
+
+    ReadyProcess pop() {
+        int level = occupied.first();
+        int node = levels[level].head;
+        levels[level].head = nodes[node].next;
+        if (levels[level].head == -1) {
+            levels[level].tail = -1;
+            occupied.erase(level);
+        }
+        freeNodes.push_back(node);
+        count--;
+        return nodes[node].process;
+    }
+
+    void advanceTo(long long time) {
+        if (boostPeriod <= 0 || time < nextBoost) return;
+        nextBoost = (time / boostPeriod + 1) * boostPeriod;
+        if (count == 0) return;
+
+        // Chain every level behind level 0, in level order, so waiting processes keep their order
+        Level merged = levels[0];
+        levels[0] = Level();
+        occupied.erase(0);
+        for (int level = occupied.first(); level != -1; level = occupied.first()) {
+            for (int node = levels[level].head; node != -1; node = nodes[node].next) nodes[node].process.level = 0;
+            if (merged.tail == -1) merged.head = levels[level].head;
+            else nodes[merged.tail].next = levels[level].head;
+            merged.tail = levels[level].tail;
+            levels[level] = Level();
+            occupied.erase(level);
+        }
+        append(0, merged.head, merged.tail);
+    }
+
+    // Empty the queue, which touches only the processes still waiting, and hand back its buffers
+    Storage release() {
+        while (!empty()) pop();
+        nodes.clear();
+        freeNodes.clear();
+        return {move(nodes), move(freeNodes), move(levels), move(occupied)};
+    }
+
+private:
+    int lastLevel;
+    long long boostPeriod;
+    long long nextBoost;
+    size_t count = 0;
+    vector<Node> nodes;
+    vector<int> freeNodes;
+    vector<Level> levels;
+    LevelBitmap occupied;
+
+    // Link the chain head..tail to the end of a level
+    void append(int level, int head, int tail) {
+        if (level >= (int)levels.size()) levels.resize(max<size_t>(levels.size() * 2, level + 1));
+        if (levels[level].tail == -1) {
+            levels[level].head = head;
+            occupied.insert(level);
+        } else {
+            nodes[levels[level].tail].next = head;
+        }
+        levels[level].tail = tail;
+    }
+};
+
+/*
+ * Scheduler storage reused from run to run: the ready queues, the HRRN tree,
+ * the lottery tickets and the remaining times of the other policies. A run
+ * borrows the buffers it needs, reserved for processCount processes, and hands
+ * them back when it ends. They keep their capacity, so after the first run over
+ * a workload the scheduling loops do not allocate (the CFS and stride tree
+ * allocates one node per arrival), and handing a buffer back only forgets its contents.
+ * An arena serves one run at a time.
+ */
+struct SchedulerArena {
+    size_t processCount = 0; // Size of the workload the buffers are reserved for
+    vector<ReadyProcess> fifoRing;
+    vector<KeyedEntry> keyedEntries;
+    MultilevelReadyQueue::Storage multilevel;
+    vector<AgingEntry> agingEntries;
+    vector<int> remainingTime;
+    vector<int> treeWinners;
+    vector<long long> treeExpiries;
+    vector<long long> ticketTree; // Lottery
+
+    // An empty buffer with room for every process
+    template <class T>
+    vector<T> borrowEmpty(vector<T>& slot) {
+        vector<T> storage = move(slot);
+        storage.clear();
+        storage.reserve(processCount);
+        return storage;
+    }
+
+    // A buffer of at least size elements, holding whatever earlier runs left in it
+    template <class T>
+    vector<T> borrowSized(vector<T>& slot, size_t size) {
+        vector<T> storage = move(slot);
+        if (storage.size() < size) storage.resize(size);
+        return storage;
+    }
+
+    FifoReadyQueue fifoQueue() { return FifoReadyQueue(borrowSized(fifoRing, FifoReadyQueue::ringSizeFor(processCount))); }
+
+    template <class Key>
+    KeyedReadyQueue<Key> keyedQueue() { return KeyedReadyQueue<Key>(borrowEmpty(keyedEntries)); }
+
+    MultilevelReadyQueue multilevelQueue(const FeedbackConfig& config) {
+        multilevel.nodes.reserve(processCount);
+        multilevel.freeNodes.reserve(processCount);
+        return MultilevelReadyQueue(config, move(multilevel));
+    }
+
+    AgingReadyQueue agingQueue() { return AgingReadyQueue(borrowEmpty(agingEntries)); }
+
+    void recycle(FifoReadyQueue& queue) { fifoRing = queue.release(); }
+    template <class Key>
+    void recycle(KeyedReadyQueue<Key>& queue) { keyedEntries = queue.release(); }
+    void recycle(MultilevelReadyQueue& queue) { multilevel = queue.release(); }
+    void recycle(AgingReadyQueue& queue) { agingEntries = queue.release(); }
+};
+
+// Quantum functions of the feedback level
+struct UnlimitedQuantum {
+    long long operator()(int) const { return LLONG_MAX; }
+};
+
+struct ConstantQuantum {
+    long long quantum;
+    long long operator()(int) const { return quantum; }
+};
+
+// Explicit quantum per level, the last one applying to every level below it
+struct LevelQuanta {
+    vector<long long> quanta;
+    long long operator()(int level) const { return quanta[min<size_t>(level, quanta.size() - 1)]; }
+};
+
+template <int Base>
+struct GeometricQuantum {
+    long long operator()(int level) const {
+        long long quantum = 1;
+        for (int i = 0; i < level && quantum <= LLONG_MAX / Base; ++i) quantum *= Base;
+        return quantum;
+    }
+};
+
+// Preemption rules: how long a dispatched process may run before it goes back to the queue
+struct ExpireQuantum {
+    static long long slice(long long quantum, int remainingTime, long long) {
+        return min<long long>(quantum, remainingTime);
+    }
+};
+
+// Only an arrival can preempt, so the process runs until one happens
+struct PreemptOnArrival {
+    static long long slice(long long quantum, int remainingTime, long long untilArrival) {
+        return min({quantum, (long long)remainingTime, untilArrival});
+    }
+};
+
+// Level rules
+struct FixedLevel {
+    static bool contended(bool, long long) { return true; }
+    static int nextLevel(int level, bool) { return level; }
+};
+
+// A process is demoted only if someone is waiting (or about to arrive) when it is dispatched.
+// Without competition it is re-dispatched at the same level, so all quanta up to the one
+// dispatched just before the next arrival are run back to back.
+struct DemoteWhenContended {
+    static bool contended(bool othersWaiting, long long untilArrival) { return othersWaiting || untilArrival <= 1; }
+    static int nextLevel(int level, bool contended) { return contended ? level + 1 : level; }
+};
+
+/*
+ * Arrivals and results of a composed policy run over a loaded workload.
+ * A feed tells the loop when the next process arrives and hands it over,
+ * and receives every run slice and completion.
+ */
+struct WorkloadFeed {
+    SimulationContext& context;
+    int currentIndex = 0;
+
+    long long horizon() const { return context.workload.lastMoment; }
+    long long nextArrival() const { return nextArrivalTime(context.workload, currentIndex); }
+    bool exhausted() const { return currentIndex == context.workload.processCount; }
+
+    ReadyProcess admit() {
+        int service = context.workload.service[currentIndex];
+        return {currentIndex++, service, service, 0};
+    }
+
+    void queued() { countPush(context); }
+    void selected(long long depth) { countPop(context, depth); }
+    void ran(int processIndex, long long start, long long end) { recordRun(context, processIndex, start, end); }
+    void completed(int processIndex, long long finishTime) { recordCompletion(context, processIndex, finishTime); }
+
+    long long dispatchOverhead(int processIndex, long long time) { return ::dispatchOverhead(context, processIndex, time); }
+    bool wantsSnapshot(long long time) const { return snapshotDue(context, time); }
+
+    template <class ReadyQueue>
+    void snapshot(long long time, const ReadyQueue& readyQueue) { takeSnapshot(context, time, currentIndex, readyQueue); }
+
+    template <class ReadyQueue>
+    void resume(long long& time, ReadyQueue& readyQueue) {
+        if (const ReadyQueue* saved = resumeSnapshot<ReadyQueue>(context, time, currentIndex)) readyQueue = *saved;
+    }
+};
+
+template <class Preemption, class LevelRule, class ReadyQueue, class Feed, class Quantum>
+void runComposedPolicy(Feed& feed, ReadyQueue readyQueue, Quantum quantumOf, SchedulerArena& arena) {
+    long long time = 0;
+    feed.resume(time, readyQueue);
+
+    auto admitArrivals = [&]() {
+        while (!feed.exhausted() && feed.nextArrival() <= time) {
+            readyQueue.push(feed.admit());
+            feed.queued();
+        }
+    };
+
+    while (time < feed.horizon()) {
+        admitArrivals();
+        if (feed.wantsSnapshot(time)) feed.snapshot(time, readyQueue);
+
+        if (readyQueue.empty()) {
+            if (feed.exhausted()) break;
+            time = feed.nextArrival(); // CPU idles until the next arrival
+            continue;
+        }
+
+        readyQueue.advanceTo(time);
+        feed.selected(readyQueue.size());
+        ReadyProcess current = readyQueue.pop();
+
+        // Switching is not preempted; whoever arrives meanwhile is queued before the slice starts
+        long long overhead = feed.dispatchOverhead(current.processIndex, time);
+        if (overhead > 0) {
+            time += overhead;
+            if (time >= feed.horizon()) break;
+            admitArrivals();
+        }
+
+        long long quantum = quantumOf(current.level);
+        long long untilArrival = feed.nextArrival() - time;
+        long long untilHorizon = feed.horizon() - time;
+        long long runFor = Preemption::slice(quantum, current.remainingTime, untilArrival);
+        bool contended = LevelRule::contended(!readyQueue.empty(), untilArrival);
+        if (!contended) {
+            long long dispatches = (min(untilHorizon, untilArrival - 1) + quantum - 1) / quantum;
+            runFor = min<long long>(current.remainingTime, dispatches * quantum);
+        }
+        runFor = min(runFor, untilHorizon);
+
+        feed.ran(current.processIndex, time, time + runFor);
+        current.remainingTime -= runFor;
+        time += runFor;
+
+        // Processes that arrived during the slice are queued ahead of the preempted one
+        admitArrivals();
+
+        if (current.remainingTime == 0) {
+            feed.completed(current.processIndex, time);
+        } else {
+            current.level = LevelRule::nextLevel(current.level, contended);
+            readyQueue.push(current);
+            feed.queued();
+        }
+    }
+    arena.recycle(readyQueue);
+}
+
+// RR and Aging slice by their quantum, so they cannot run without a positive one
+inline bool requiresQuantum(char algorithmId) {
+    return algorithmId == '2' || algorithmId == '8';
+}
+
+inline bool isComposedAlgorithm(char algorithmId) {
+    return algorithmId >= '1' && algorithmId <= '7' && algorithmId != '5';
+}
+
+// Run one of the composed policies over a feed, with its ready queue borrowed from arena;
+// false if the algorithm is not one of them
+template <class Feed>
+bool runComposedAlgorithm(Feed& feed, char algorithmId, int quantum, const FeedbackConfig& feedback, SchedulerArena& arena) {
+    switch (algorithmId)
+    {
+    case '1':
+        runComposedPolicy<ExpireQuantum, FixedLevel>(feed, arena.fifoQueue(), UnlimitedQuantum(), arena);
+        return true;
+    case '2':
+        runComposedPolicy<ExpireQuantum, FixedLevel>(feed, arena.fifoQueue(), ConstantQuantum{quantum}, arena);
+        return true;
+    case '3':
+        runComposedPolicy<ExpireQuantum, FixedLevel>(feed, arena.keyedQueue<KeyByServiceTime>(), UnlimitedQuantum(), arena);
+        return true;
+    case '4':
+        runComposedPolicy<PreemptOnArrival, FixedLevel>(feed, arena.keyedQueue<KeyByRemainingTime>(), UnlimitedQuantum(), arena);
+        return true;
+    case '6':
+    case '7':
+        if (!feedback.quanta.empty()) {
+            runComposedPolicy<ExpireQuantum, DemoteWhenContended>(feed, arena.multilevelQueue(feedback), LevelQuanta{feedback.quanta}, arena);
+        } else if (algorithmId == '6') {
+            runComposedPolicy<ExpireQuantum, DemoteWhenContended>(feed, arena.multilevelQueue(feedback), ConstantQuantum{1}, arena);
+        } else {
+            runComposedPolicy<ExpireQuantum, DemoteWhenContended>(feed, arena.multilevelQueue(feedback), GeometricQuantum<2>(), arena);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*
+ * Kinetic tournament tree holding the HRRN ready queue.
+ * The response ratio (time - arrival + service) / service of a waiting process
+ * grows linearly with time, so the leader of any two processes changes at most
+ * once, when their ratio lines cross. Each node keeps the winner of its subtree
+ * and the earliest time at which a match below it may change; advancing the
+ * clock replays only the matches whose certificates have expired.
+ * Equal ratios keep the order of the previous decision: the longer job leads
+ * if both were already waiting then, otherwise the earlier process does.
+ */
+struct ResponseRatioTree {
+    static constexpr long long NEVER = LLONG_MAX;
+
+    const Workload& workload;
+    int leafCount = 1;
+    int waiting = 0; // Number of processes in the tree
+    long long time = 0;
+    long long previousDecision = LLONG_MIN; // Time of the last selection, used to break ties
+    vector<int> winner;       // Process index winning the subtree, -1 if empty
+    vector<long long> expiry; // Earliest time a match in the subtree changes its result
+
+    // The tree can be built in buffers borrowed from an arena, whose old contents are overwritten
+    ResponseRatioTree(const Workload& workload, vector<int> winnerStorage = {}, vector<long long> expiryStorage = {})
+        : workload(workload), winner(move(winnerStorage)), expiry(move(expiryStorage)) {
+        while (leafCount < workload.processCount) leafCount *= 2;
+        winner.assign(2 * leafCount, -1);
+        expiry.assign(2 * leafCount, NEVER);
+    }
+
+    bool empty() const { return winner[1] == -1; }
+    int size() const { return waiting; }
+    int top() const { return winner[1]; }
+
+    // True if process a has priority over process b at the current time
+    bool beats(int a, int b) const {
+        long long arrivalA = workload.arrival[a], serviceA = workload.service[a];
+        long long arrivalB = workload.arrival[b], serviceB = workload.service[b];
+        __int128 ratioA = (__int128)(time - arrivalA + serviceA) * serviceB;
+        __int128 ratioB = (__int128)(time - arrivalB + serviceB) * serviceA;
+        if (ratioA != ratioB) return ratioA > ratioB;
+        if (serviceA != serviceB && max(arrivalA, arrivalB) <= previousDecision) return serviceA > serviceB;
+        return a < b;
+    }
+
+    // First time at which the loser's ratio may catch up with the winner's
+    long long overtakeTime(int winnerIndex, int loserIndex) const {
+        long long arrivalW = workload.arrival[winnerIndex], serviceW = workload.service[winnerIndex];
+        long long arrivalL = workload.arrival[loserIndex], serviceL = workload.service[loserIndex];
+        if (serviceL >= serviceW) return NEVER; // The loser's ratio never grows faster
+        long long numerator = arrivalL * serviceW - arrivalW * serviceL;
+        long long denominator = serviceW - serviceL;
+        return max((numerator + denominator - 1) / denominator, time + 1);
+    }
+
+    void replayMatch(int node) {
+        int left = winner[2 * node], right = winner[2 * node + 1];
+        long long matchExpiry = NEVER;
+        if (left == -1 || right == -1) {
+            winner[node] = left == -1 ? right : left;
+        } else if (beats(left, right)) {
+            winner[node] = left;
+            matchExpiry = overtakeTime(left, right);
+        } else {
+            winner[node] = right;
+            matchExpiry = overtakeTime(right, left);
+        }
+        expiry[node] = min({matchExpiry, expiry[2 * node], expiry[2 * node + 1]});
+    }
+
+    void refresh(int node) {
+        if (expiry[node] > time) return;
+        refresh(2 * node);
+        refresh(2 * node + 1);
+        replayMatch(node);
+    }
+
+    void advanceTo(long long newTime) {
+        time = newTime;
+        refresh(1);
+    }
+
+    void setLeaf(int processIndex, int value) {
+        int node = leafCount + processIndex;
+        winner[node] = value;
+        for (node /= 2; node >= 1; node /= 2) {
+            replayMatch(node);
+        }
+    }
+
+    void insert(int processIndex) {
+        setLeaf(processIndex, processIndex);
+        waiting++;
+    }
+
+    void remove(int processIndex) {
+        setLeaf(processIndex, -1);
+        waiting--;
+    }
+
+    vector<int> waitingProcesses() const {
+        vector<int> processes;
+        for (int i = 0; i < workload.processCount; ++i) {
+            if (winner[leafCount + i] != -1) processes.push_back(i);
+        }
+        return processes;
+    }
+};
+
+// Saved HRRN state: the tree is rebuilt from it, since its size depends on the workload
+struct HrrnSnapshot {
+    vector<int> waiting;
+    long long previousDecision;
+};
+
+// Highest Response Ratio Next (HRRN) scheduling algorithm
+inline void runHRRN(SimulationContext& context, SchedulerArena& arena) {
+    const Workload& workload = context.workload;
+    ResponseRatioTree readyQueue(workload, move(arena.treeWinners), move(arena.treeExpiries));
+    int currentIndex = 0;
+    int time = 0;
+
+    long long resumedTime = 0;
+    if (const HrrnSnapshot* saved = resumeSnapshot<HrrnSnapshot>(context, resumedTime, currentIndex)) {
+        time = resumedTime;
+        readyQueue.advanceTo(time);
+        for (int processIndex : saved->waiting) readyQueue.insert(processIndex);
+        readyQueue.previousDecision = saved->previousDecision;
+    }
+
+    while (time < workload.lastMoment) {
+        readyQueue.advanceTo(time);
+        while (nextArrivalTime(workload, currentIndex) <= time) {
+            readyQueue.insert(currentIndex);
+            countPush(context);
+            currentIndex++;
+        }
+        if (snapshotDue(context, time)) {
+            takeSnapshot(context, time, currentIndex, HrrnSnapshot{readyQueue.waitingProcesses(), readyQueue.previousDecision});
+        }
+
+        if (readyQueue.empty()) {
+            if (currentIndex == workload.processCount) break;
+            time = nextArrivalTime(workload, currentIndex);
+            continue;
+        }
+
+        int idx = readyQueue.top();
+        countPop(context, readyQueue.size());
+        readyQueue.remove(idx);
+        readyQueue.previousDecision = time;
+        time += dispatchOverhead(context, idx, time);
+        if (time >= workload.lastMoment) break;
+
+        int finishTime = time + workload.service[idx];
+        recordRun(context, idx, time, finishTime);
+        recordCompletion(context, idx, finishTime);
+        time = finishTime;
+    }
+    arena.treeWinners = move(readyQueue.winner);
+    arena.treeExpiries = move(readyQueue.expiry);
+}
+
+struct AgingSnapshot {
+    AgingReadyQueue readyQueue;
+    vector<int> remainingTime; // Of the admitted processes
+    long long decisions;
+};
+
+// Aging scheduling algorithm
+inline void runAging(SimulationContext& context, int quantum, SchedulerArena& arena)
+{
+    const Workload& workload = context.workload;
+    AgingReadyQueue readyQueue = arena.agingQueue();
+    vector<int> remainingTime = arena.borrowSized(arena.remainingTime, workload.processCount); // Set on arrival
+    long long decisions = 0;                 // Scheduling decisions so far, the global aging offset
+    int currentIndex = 0;
+    int time = 0;
+
+    long long resumedTime = 0;
+    if (const AgingSnapshot* saved = resumeSnapshot<AgingSnapshot>(context, resumedTime, currentIndex)) {
+        time = resumedTime;
+        readyQueue = saved->readyQueue;
+        copy(saved->remainingTime.begin(), saved->remainingTime.end(), remainingTime.begin());
+        decisions = saved->decisions;
+    }
+
+    // Main simulation loop, advanced one scheduling decision at a time.
+    while (time < workload.lastMoment) {
+        // Add new arrivals to the ready queue with a wait counter of zero.
+        while (nextArrivalTime(workload, currentIndex) <= time) {
+            readyQueue.push({workload.service[currentIndex] - decisions, decisions, -1, currentIndex});
+            countPush(context);
+            remainingTime[currentIndex] = workload.service[currentIndex];
+            currentIndex++;
+        }
+        if (snapshotDue(context, time)) {
+            vector<int> admittedRemaining(remainingTime.begin(), remainingTime.begin() + currentIndex);
+            takeSnapshot(context, time, currentIndex, AgingSnapshot{readyQueue, move(admittedRemaining), decisions});
+        }
+
+        // Jump ahead to the next arrival if no processes are ready.
+        if (readyQueue.empty()) {
+            if (currentIndex == workload.processCount) break;
+            time = nextArrivalTime(workload, currentIndex);
+            continue;
+        }
+
+        // Select the process with the highest priority.
+        AgingEntry current = readyQueue.top();
+        countPop(context, readyQueue.size());
+        readyQueue.pop();
+        int currentProcess = current.processIndex;
+        time += dispatchOverhead(context, currentProcess, time);
+        if (time >= workload.lastMoment) break;
+
+        // Execute the selected process for its quantum or until finished.
+        int slice = min({quantum, remainingTime[currentProcess], workload.lastMoment - time});
+        recordRun(context, currentProcess, time, time + slice);
+        remainingTime[currentProcess] -= slice;
+        time += slice;
+
+        if (remainingTime[currentProcess] == 0) {
+            recordCompletion(context, currentProcess, time);
+        } else {
+            // Everyone else ages by advancing the global offset; the selected process does not.
+            current.relativePriority--;
+            current.base++;
+            current.lastSelected = decisions;
+            readyQueue.push(current);
+            countPush(context);
+        }
+        decisions++;
+    }
+    arena.recycle(readyQueue);
+    arena.remainingTime = move(remainingTime);
+}
+
+/*
+ * Proportional-share schedulers: CFS and stride scheduling.
+ * As for Aging, the third field of a process is its weight (its tickets) and
+ * also the CPU time it needs. Each process carries a pass value that grows by
+ * its stride, inversely proportional to its weight, for every quantum it runs
+ * (pro rata for a shorter slice). The ready process with the smallest pass runs
+ * next, so over time each one gets CPU in proportion to its weight. The policies
+ * differ in where a newcomer starts:
+ *   CFS    - at the smallest virtual runtime in the system, so it is owed nothing for the time before it arrived
+ *   stride - one stride past the global pass, which advances as if every quantum were split over all tickets
+ * Ties go to the process queued first, and arrivals queue ahead of the process
+ * whose slice just ended. A process that runs alone keeps the CPU in whole quanta
+ * until someone arrives.
+ * The ready processes are an ordered tree keyed by pass. The dispatched process's
+ * node is taken out and re-inserted with its new pass, so a dispatch costs O(log n)
+ * and allocates nothing; only arrivals allocate a node.
+ * Passes are 128-bit: the stride of the total weight must stay well above 1 for
+ * traces of millions of jobs with weights up to INT_MAX, and the passes of a run
+ * of INT_MAX time units must not overflow.
+ */
+using Pass = __int128;
+inline const Pass PASS_SCALE = (Pass)720720 << 64; // Stride of weight 1, a multiple of every weight up to 16
+
+struct FairShareEntry {
+    Pass pass;
+    long long sequence; // Queue order, breaking ties between equal passes
+    int processIndex;
+
+    bool operator<(const FairShareEntry& other) const {
+        return pass != other.pass ? pass < other.pass : sequence < other.sequence;
+    }
+};
+
+inline long long fairShareWeight(const Workload& workload, int processIndex) {
+    return max(workload.service[processIndex], 1);
+}
+
+// Pass gained by running slice time units: the stride for every whole quantum, pro rata for the rest
+inline Pass passAdvance(Pass stride, long long slice, long long quantum) {
+    return slice / quantum * stride + slice % quantum * stride / quantum;
+}
+
+// Quantum for a process running alone: whole quanta up to the next arrival, at least one
+inline long long loneSlice(long long quantum, long long remainingTime, long long untilArrival, long long untilHorizon) {
+    long long quanta = max(1LL, (min(untilHorizon, untilArrival - 1) + quantum - 1) / quantum);
+    return min(remainingTime, quanta * quantum);
+}
+
+inline void runFairShare(SimulationContext& context, int quantum, bool strideScheduling, SchedulerArena& arena) {
+    const Workload& workload = context.workload;
+    quantum = max(quantum, 1);
+    set<FairShareEntry> readyQueue;
+    vector<int> remainingTime = arena.borrowSized(arena.remainingTime, workload.processCount); // Set on arrival
+    long long sequence = 0;
+    Pass minimumPass = 0; // CFS: never decreasing smallest pass of the runnable processes
+    Pass globalPass = 0;  // Stride: pass of a client holding every ticket
+    long long totalTickets = 0;
+    int currentIndex = 0;
+    int time = 0;
+
+    auto admitArrivals = [&]() {
+        while (nextArrivalTime(workload, currentIndex) <= time) {
+            int processIndex = currentIndex++;
+            long long weight = fairShareWeight(workload, processIndex);
+            Pass pass = strideScheduling ? globalPass + PASS_SCALE / weight : minimumPass;
+            readyQueue.insert({pass, sequence++, processIndex});
+            countPush(context);
+            remainingTime[processIndex] = workload.service[processIndex];
+            totalTickets += weight;
+        }
+    };
+
+    while (time < workload.lastMoment) {
+        admitArrivals();
+        if (readyQueue.empty()) {
+            if (currentIndex == workload.processCount) break;
+            time = nextArrivalTime(workload, currentIndex);
+            continue;
+        }
+
+        countPop(context, readyQueue.size());
+        auto node = readyQueue.extract(readyQueue.begin());
+        FairShareEntry& current = node.value();
+        int currentProcess = current.processIndex;
+        long long overhead = dispatchOverhead(context, currentProcess, time);
+        if (overhead > 0) {
+            time += overhead;
+            if (time >= workload.lastMoment) break;
+            admitArrivals();
+        }
+
+        long long untilArrival = (long long)nextArrivalTime(workload, currentIndex) - time;
+        long long untilHorizon = workload.lastMoment - time;
+        long long slice = min<long long>(quantum, remainingTime[currentProcess]);
+        if (readyQueue.empty()) slice = loneSlice(quantum, remainingTime[currentProcess], untilArrival, untilHorizon);
+        slice = min(slice, untilHorizon);
+        recordRun(context, currentProcess, time, time + slice);
+        remainingTime[currentProcess] -= slice;
+        time += slice;
+
+        long long weight = fairShareWeight(workload, currentProcess);
+        current.pass += passAdvance(PASS_SCALE / weight, slice, quantum);
+        globalPass += passAdvance(PASS_SCALE / totalTickets, slice, quantum);
+        bool finished = remainingTime[currentProcess] == 0;
+        if (finished) {
+            recordCompletion(context, currentProcess, time);
+            totalTickets -= weight;
+        }
+        if (!finished || !readyQueue.empty()) {
+            Pass smallestPass = finished ? readyQueue.begin()->pass : current.pass;
+            if (!readyQueue.empty()) smallestPass = min(smallestPass, readyQueue.begin()->pass);
+            minimumPass = max(minimumPass, smallestPass);
+        }
+
+        admitArrivals();
+        if (!finished) {
+            current.sequence = sequence++;
+            readyQueue.insert(move(node));
+            countPush(context);
+        }
+    }
+    arena.remainingTime = move(remainingTime);
+}
+
+/*
+ * Lottery scheduling: every quantum goes to a ticket drawn at random from the
+ * tickets of all ready processes, so a process wins in proportion to its weight
+ * (the third field, as for CFS and stride). Tickets are kept in a Fenwick tree
+ * over process numbers, so a draw walks down the tree in O(log n). Draws use a
+ * fixed seed, so a run always repeats exactly. A process that runs alone keeps
+ * the CPU in whole quanta until someone arrives, without drawing.
+ */
+inline const uint64_t LOTTERY_SEED = 0x5DEECE66DULL;
+
+// SplitMix64 step, mapped onto [0, range) with a multiply, so draws are the same on every platform
+inline long long drawTicket(uint64_t& state, long long range) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (long long)(((unsigned __int128)z * (uint64_t)range) >> 64);
+}
+
+inline void runLottery(SimulationContext& context, int quantum, SchedulerArena& arena) {
+    const Workload& workload = context.workload;
+    int processCount = workload.processCount;
+    quantum = max(quantum, 1);
+    vector<long long> tickets = arena.borrowSized(arena.ticketTree, processCount + 1); // Fenwick tree, 1-based
+    fill(tickets.begin(), tickets.begin() + processCount + 1, 0LL);
+    vector<int> remainingTime = arena.borrowSized(arena.remainingTime, processCount); // Set on arrival
+    int topBit = 1;
+    while (topBit * 2 <= processCount) topBit *= 2;
+    long long totalTickets = 0;
+    int waiting = 0;
+    uint64_t random = LOTTERY_SEED;
+    int currentIndex = 0;
+    int time = 0;
+
+    auto addTickets = [&](int processIndex, long long count) {
+        for (int node = processIndex + 1; node <= processCount; node += node & -node) tickets[node] += count;
+        totalTickets += count;
+    };
+    // Process holding ticket number `ticket`, counting the tickets in process order
+    auto ticketHolder = [&](long long ticket) {
+        int node = 0;
+        for (int bit = topBit; bit > 0; bit /= 2) {
+            if (node + bit <= processCount && tickets[node + bit] <= ticket) {
+                node += bit;
+                ticket -= tickets[node];
+            }
+        }
+        return node;
+    };
+    auto enqueue = [&](int processIndex) {
+        addTickets(processIndex, fairShareWeight(workload, processIndex));
+        countPush(context);
+        waiting++;
+    };
+
+    while (time < workload.lastMoment) {
+        while (nextArrivalTime(workload, currentIndex) <= time) {
+            remainingTime[currentIndex] = workload.service[currentIndex];
+            enqueue(currentIndex++);
+        }
+        if (waiting == 0) {
+            if (currentIndex == processCount) break;
+            time = nextArrivalTime(workload, currentIndex);
+            continue;
+        }
+
+        countPop(context, waiting);
+        int currentProcess = ticketHolder(waiting > 1 ? drawTicket(random, totalTickets) : 0);
+        addTickets(currentProcess, -fairShareWeight(workload, currentProcess));
+        waiting--;
+        time += dispatchOverhead(context, currentProcess, time);
+        if (time >= workload.lastMoment) break;
+        while (nextArrivalTime(workload, currentIndex) <= time) {
+            remainingTime[currentIndex] = workload.service[currentIndex];
+            enqueue(currentIndex++);
+        }
+
+        long long untilArrival = (long long)nextArrivalTime(workload, currentIndex) - time;
+        long long untilHorizon = workload.lastMoment - time;
+        long long slice = min<long long>(quantum, remainingTime[currentProcess]);
+        if (waiting == 0) slice = loneSlice(quantum, remainingTime[currentProcess], untilArrival, untilHorizon);
+        slice = min(slice, untilHorizon);
+        recordRun(context, currentProcess, time, time + slice);
+        remainingTime[currentProcess] -= slice;
+        time += slice;
+
+        if (remainingTime[currentProcess] == 0) {
+            recordCompletion(context, currentProcess, time);
+        } else {
+            enqueue(currentProcess);
+        }
+    }
+    arena.ticketTree = move(tickets);
+    arena.remainingTime = move(remainingTime);
+}
+
+// Display name of an algorithm entry, e.g. "RR-4"
+inline string algorithmName(const pair<char, int>& algorithm) {
+    string name = SCHEDULING_ALGORITHMS[algorithm.first - '0'];
+    if (algorithm.second > 0) name += "-" + to_string(algorithm.second);
+    return name;
+}
+
+inline void executeSchedulingAlgorithm(SimulationContext& context, char algorithmId, int quantum) {
+    SchedulerArena localArena;
+    SchedulerArena& arena = context.arena ? *context.arena : localArena;
+    arena.processCount = context.workload.processCount;
+
+    WorkloadFeed feed{context};
+    if (runComposedAlgorithm(feed, algorithmId, quantum, context.feedback, arena)) return;
+
+    switch (algorithmId)
+    {
+    case '5':
+        runHRRN(context, arena);
+        break;
+    case '8':
+        runAging(context, quantum, arena);
+        break;
+    case CFS_ID:
+        runFairShare(context, quantum, false, arena);
+        break;
+    case STRIDE_ID:
+        runFairShare(context, quantum, true, arena);
+        break;
+    case LOTTERY_ID:
+        runLottery(context, quantum, arena);
+        break;
+    default:
+        cerr << "Invalid algorithm ID!" << endl;
+        break;
+    }
+}
+
+#endif // SCHEDULER_ALGORITHMS_H
@@ -0,0 +1,271 @@
+#ifndef SCHEDULER_CHROME_TRACE_H
+#define SCHEDULER_CHROME_TRACE_H
+
+#include <bits/stdc++.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "scheduler_parser.h"
+
+using namespace std;
+
+/** Header for exporting runs in the Chrome trace-event format, readable by chrome://tracing and Perfetto **/
+
+/*
+ * The JSON array that the runs of one invocation stream their events into.
+ * Every run writes whole events in large chunks, so runs on different threads
+ * only take the lock to append a chunk and their events never interleave.
+ */
+class ChromeTraceFile {
+public:
+    explicit ChromeTraceFile(const string& path) : fd(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) {
+        if (fd >= 0) writeAll("[");
+    }
+
+    ~ChromeTraceFile() { close(); }
+
+    bool isOpen() const { return fd >= 0; }
+
+    // Append events that each start with a ',' separator; the very first one drops it
+    void append(string_view events) {
+        lock_guard<mutex> lock(appending);
+        if (!started && !events.empty()) {
+            events.remove_prefix(1);
+            started = true;
+        }
+        writeAll(events);
+    }
+
+    // Terminate the array; false if any write failed
+    bool close() {
+        if (fd < 0) return !failed;
+        writeAll("\n]\n");
+        failed |= ::close(fd) != 0;
+        fd = -1;
+        return !failed;
+    }
+
+private:
+    int fd;
+    mutex appending;
+    bool started = false;
+    bool failed = false;
+
+    void writeAll(string_view data) {
+        while (!data.empty() && fd >= 0) {
+            ssize_t count = ::write(fd, data.data(), data.size());
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                failed = true;
+                return;
+            }
+            data.remove_prefix(count);
+        }
+    }
+};
+
+/*
+ * Trace events of one run, shown as one trace process with a track per CPU.
+ *   run slices      complete events on the track of the CPU they ran on
+ *   waits           async events from arrival, or the end of the previous slice, to the next dispatch
+ *   preemptions     instant events where a slice ended before its process finished
+ *   switch overhead complete events for the time the switch cost model charged
+ * A simulation tick is one microsecond of trace time. Events are formatted into
+ * a buffer of fixed capacity that is handed to the file whenever it fills up, so
+ * memory stays bounded however long the run is.
+ */
+class ChromeTraceWriter {
+public:
+    ChromeTraceWriter(ChromeTraceFile& file, const Workload& workload, int run, string_view runName, int coreCount, size_t capacity = 1 << 20)
+        : file(file), workload(workload), pid(run + 1), capacity(capacity),
+          lastEnd(workload.processCount, NEVER_RAN), lastCore(workload.processCount, 0) {
+        buffer.reserve(capacity + 256);
+        metadata("process_name", -1, runName);
+        beginEvent("process_sort_index", "", 'M', -1);
+        buffer += ",\"args\":{\"sort_index\":";
+        appendInt(pid);
+        buffer += "}}";
+        for (int core = 0; core < coreCount; ++core) metadata("thread_name", core, "CPU " + to_string(core));
+    }
+
+    ~ChromeTraceWriter() { finish(); }
+
+    // Run slice of a process on a CPU; adjacent slices of the same process on the same CPU merge
+    void slice(int processIndex, int core, int start, int end) {
+        if (pending.processIndex == processIndex && pending.core == core && pending.end == start) {
+            pending.end = end;
+            lastEnd[processIndex] = end;
+            return;
+        }
+        int readySince = lastEnd[processIndex] >= 0 ? lastEnd[processIndex] : workload.arrival[processIndex];
+        if (lastEnd[processIndex] >= 0 && start > lastEnd[processIndex]) {
+            preemption(processIndex, lastCore[processIndex], lastEnd[processIndex]);
+        }
+        if (start > readySince) wait(processIndex, readySince, start);
+        emitPending();
+        pending = {processIndex, core, start, end};
+        lastEnd[processIndex] = end;
+        lastCore[processIndex] = core;
+    }
+
+    void completed(int processIndex) {
+        lastEnd[processIndex] = FINISHED;
+    }
+
+    // CPU time lost switching to processIndex before its slice
+    void switchOverhead(int processIndex, long long time, long long duration) {
+        beginEvent("switch", "switch", 'X', 0);
+        appendTime(time, duration);
+        buffer += ",\"args\":{\"to\":";
+        appendString(workload.name(processIndex));
+        buffer += "}}";
+        eventDone();
+    }
+
+    /*
+     * Close the run at lastMoment: processes still waiting get their wait up to the
+     * end, and the ones that were last descheduled unfinished their preemption.
+     */
+    void finish() {
+        if (finished) return;
+        finished = true;
+        emitPending();
+        int horizon = workload.lastMoment;
+        for (int i = 0; i < workload.processCount && workload.arrival[i] < horizon; ++i) {
+            if (lastEnd[i] == FINISHED || lastEnd[i] >= horizon) continue;
+            if (lastEnd[i] >= 0) preemption(i, lastCore[i], lastEnd[i]);
+            wait(i, lastEnd[i] >= 0 ? lastEnd[i] : workload.arrival[i], horizon);
+        }
+        flush();
+    }
+
+private:
+    static constexpr int NEVER_RAN = -1;
+    static constexpr int FINISHED = -2;
+
+    struct PendingSlice {
+        int processIndex = -1;
+        int core = 0;
+        int start = 0;
+        int end = 0;
+    };
+
+    ChromeTraceFile& file;
+    const Workload& workload;
+    int pid;
+    size_t capacity;
+    string buffer;
+    vector<int> lastEnd;  // End of the latest slice of each process, NEVER_RAN or FINISHED
+    vector<int> lastCore; // CPU of that slice
+    PendingSlice pending; // Latest slice, held back so that continuations extend it
+    bool finished = false;
+
+    void emitPending() {
+        if (pending.processIndex < 0) return;
+        beginEvent(workload.name(pending.processIndex), "run", 'X', pending.core);
+        appendTime(pending.start, pending.end - pending.start);
+        buffer += '}';
+        eventDone();
+        pending.processIndex = -1;
+    }
+
+    void preemption(int processIndex, int core, int time) {
+        beginEvent("preempted", "preempt", 'i', core);
+        buffer += ",\"s\":\"t\"";
+        appendTime(time, -1);
+        buffer += ",\"args\":{\"process\":";
+        appendString(workload.name(processIndex));
+        buffer += "}}";
+        eventDone();
+    }
+
+    // A begin and end pair, matched by an id unique to the run and process
+    void wait(int processIndex, int start, int end) {
+        for (char phase : {'b', 'e'}) {
+            beginEvent("waiting", "wait", phase, 0);
+            buffer += ",\"id\":\"";
+            appendInt(pid);
+            buffer += '.';
+            appendInt(processIndex);
+            buffer += '"';
+            appendTime(phase == 'b' ? start : end, -1);
+            if (phase == 'b') {
+                buffer += ",\"args\":{\"process\":";
+                appendString(workload.name(processIndex));
+                buffer += '}';
+            }
+            buffer += '}';
+            eventDone();
+        }
+    }
+
+    void metadata(string_view kind, int tid, string_view name) {
+        beginEvent(kind, "", 'M', tid);
+        buffer += ",\"args\":{\"name\":";
+        appendString(name);
+        buffer += "}}";
+        eventDone();
+    }
+
+    // Opens the event object; a negative tid leaves the thread out
+    void beginEvent(string_view name, string_view category, char phase, int tid) {
+        buffer += ",\n{\"name\":";
+        appendString(name);
+        if (!category.empty()) {
+            buffer += ",\"cat\":\"";
+            buffer += category;
+            buffer += '"';
+        }
+        buffer += ",\"ph\":\"";
+        buffer += phase;
+        buffer += "\",\"pid\":";
+        appendInt(pid);
+        if (tid >= 0) {
+            buffer += ",\"tid\":";
+            appendInt(tid);
+        }
+    }
+
+    // Timestamp, and the duration unless it is negative
+    void appendTime(long long time, long long duration) {
+        buffer += ",\"ts\":";
+        appendInt(time);
+        if (duration >= 0) {
+            buffer += ",\"dur\":";
+            appendInt(duration);
+        }
+    }
+
+    void appendInt(long long value) {
+        char digits[24];
+        buffer.append(digits, to_chars(digits, digits + sizeof(digits), value).ptr - digits);
+    }
+
+    void appendString(string_view text) {
+        buffer += '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                buffer += '\\';
+                buffer += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                buffer += escaped;
+            } else {
+                buffer += c;
+            }
+        }
+        buffer += '"';
+    }
+
+    // Events are only handed over whole, so a full buffer is flushed between events
+    void eventDone() {
+        if (buffer.size() >= capacity) flush();
+    }
+
+    void flush() {
+        file.append(buffer);
+        buffer.clear();
+    }
+};
+
+#endif // SCHEDULER_CHROME_TRACE_H
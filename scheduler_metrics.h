@@ -0,0 +1,54 @@
+#ifndef SCHEDULER_METRICS_H
+#define SCHEDULER_METRICS_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+/** Header for the opt-in run instrumentation and its JSON export **/
+
+using MetricsClock = chrono::steady_clock;
+
+inline double secondsSince(MetricsClock::time_point start) {
+    return chrono::duration<double>(MetricsClock::now() - start).count();
+}
+
+/*
+ * Event counters and phase timers of one scheduling run.
+ * A run only updates them when its context points at an instance, so with
+ * instrumentation off the hot loops pay a single predictable branch.
+ * On several cores dispatches and context switches are summed over the cores,
+ * each core counting switches against the last process it ran itself.
+ */
+struct RunCounters {
+    long long dispatches = 0;      // Run slices handed to a process
+    long long contextSwitches = 0; // Dispatches of a different process than the last one to run on that core
+    long long queuePushes = 0;
+    long long queuePops = 0;
+    long long maxQueueDepth = 0;
+    long long queueDepthSum = 0;   // Ready-queue depth summed over selections, for the mean
+    vector<int> lastProcess;       // Last process run on each core, -1 before the first
+    double simulateSeconds = 0;
+    double printSeconds = 0;
+};
+
+// Write the counters of every run, labelled by algorithm name, as one JSON document
+inline bool writeMetricsJson(const string& path, double parseSeconds, double totalSeconds,
+                      const vector<string>& labels, const vector<RunCounters>& runs) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) return false;
+    fprintf(file, "{\n  \"parse_seconds\": %.9f,\n  \"total_seconds\": %.9f,\n  \"runs\": [\n", parseSeconds, totalSeconds);
+    for (size_t i = 0; i < runs.size(); ++i) {
+        const RunCounters& run = runs[i];
+        double meanDepth = run.queuePops ? 1.0 * run.queueDepthSum / run.queuePops : 0;
+        fprintf(file, "    {\"algorithm\": \"%s\", \"simulate_seconds\": %.9f, \"print_seconds\": %.9f, "
+                      "\"dispatches\": %lld, \"context_switches\": %lld, \"queue_pushes\": %lld, \"queue_pops\": %lld, "
+                      "\"max_queue_depth\": %lld, \"mean_queue_depth\": %.3f}%s\n",
+                labels[i].c_str(), run.simulateSeconds, run.printSeconds, run.dispatches, run.contextSwitches,
+                run.queuePushes, run.queuePops, run.maxQueueDepth, meanDepth, i + 1 < runs.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+#endif // SCHEDULER_METRICS_H
@@ -0,0 +1,104 @@
+#ifndef SCHEDULER_MONTECARLO_H
+#define SCHEDULER_MONTECARLO_H
+
+#include <bits/stdc++.h>
+#include "scheduler_parser.h"
+#include "scheduler_algorithms.h"
+#include "scheduler_percentiles.h"
+#include "scheduler_sweep.h"
+#include "workload_generator.h"
+
+using namespace std;
+
+/** Header for Monte Carlo replication of a workload and confidence intervals over the replicas **/
+
+/*
+ * Fit the generator's workload shape to a workload.
+ * The mean interarrival time and mean service time are matched exactly.
+ * Arrivals sharing a timestamp are read as batches: with two or more processes
+ * per distinct arrival time on average, arrivals are bursty with that mean batch size.
+ * Service times with a coefficient of variation above 1.2 are fitted with a
+ * Pareto distribution of the same mean and variance, others as exponential.
+ */
+inline WorkloadShape fitWorkloadShape(const Workload& workload) {
+    WorkloadShape shape;
+    int count = workload.processCount;
+    if (count == 0) return shape;
+
+    double serviceSum = 0, serviceSquares = 0;
+    int distinctArrivals = 0;
+    for (int i = 0; i < count; ++i) {
+        serviceSum += workload.service[i];
+        serviceSquares += (double)workload.service[i] * workload.service[i];
+        distinctArrivals += i == 0 || workload.arrival[i] != workload.arrival[i - 1];
+    }
+    shape.meanService = max(1.0, serviceSum / count);
+    double variance = max(0.0, serviceSquares / count - (serviceSum / count) * (serviceSum / count));
+    double variation = sqrt(variance) / shape.meanService;
+    if (variation > 1.2) {
+        shape.service = "pareto";
+        shape.paretoShape = 1 + sqrt(1 + 1 / (variation * variation));
+    }
+
+    double meanInterarrival = count > 1 ? (double)(workload.arrival[count - 1] - workload.arrival[0]) / (count - 1) : shape.meanService;
+    shape.loadFactor = shape.meanService / max(meanInterarrival, 1e-3);
+    if (count >= 2 * distinctArrivals) {
+        shape.arrivals = "bursty";
+        shape.meanBurstSize = (double)count / distinctArrivals;
+    }
+    return shape;
+}
+
+// Seed of replica r: a SplitMix64 step, so neighbouring replicas get unrelated streams
+inline uint64_t replicaSeed(uint64_t seed, int replica) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (uint64_t)(replica + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// What one replica measured for one algorithm
+struct ReplicaMetrics {
+    double meanTurnaround = 0;
+    double meanNormalizedTurnaround = 0;
+    double p99Turnaround = 0;
+};
+
+// The means and the p99 all cover the finished processes only
+inline ReplicaMetrics measureReplica(const SimulationContext& context) {
+    SweepResult means = summarizeRun(context);
+    unique_ptr<LatencySummary> latency = summarizeLatency(context);
+    return {means.meanTurnaround, means.meanNormalizedTurnaround, (double)latency->turnaround.percentile(0.99)};
+}
+
+// Two-sided 97.5% quantile of Student's t distribution
+inline double studentT975(int degreesOfFreedom) {
+    static const double table[] = {0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (degreesOfFreedom <= 30) return table[max(1, degreesOfFreedom)];
+    if (degreesOfFreedom <= 60) return 2.042 - (degreesOfFreedom - 30) * (2.042 - 2.000) / 30;
+    if (degreesOfFreedom <= 120) return 2.000 - (degreesOfFreedom - 60) * (2.000 - 1.980) / 60;
+    return 1.960;
+}
+
+// Sample mean and the half width of its 95% confidence interval (0 with a single sample)
+struct ConfidenceInterval {
+    double mean = 0;
+    double halfWidth = 0;
+};
+
+inline ConfidenceInterval confidenceInterval(const vector<double>& samples) {
+    ConfidenceInterval interval;
+    int count = samples.size();
+    if (count == 0) return interval;
+    for (double sample : samples) interval.mean += sample;
+    interval.mean /= count;
+    if (count < 2) return interval;
+    double squares = 0;
+    for (double sample : samples) squares += (sample - interval.mean) * (sample - interval.mean);
+    interval.halfWidth = studentT975(count - 1) * sqrt(squares / (count - 1) / count);
+    return interval;
+}
+
+#endif // SCHEDULER_MONTECARLO_H
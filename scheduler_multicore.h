@@ -0,0 +1,199 @@
+#ifndef SCHEDULER_MULTICORE_H
+#define SCHEDULER_MULTICORE_H
+
+#include <bits/stdc++.h>
+#include "scheduler_parser.h"
+#include "scheduler_algorithms.h"
+
+using namespace std;
+
+/** Header for simulating a machine with several CPUs, each with its own ready queue **/
+
+// Entry of a per-core ready queue: smallest key first, then smallest tie-breaker
+struct CoreReadyEntry {
+    long long key;
+    long long sequence; // Enqueue order for FCFS and RR, process index for the other policies
+    int processIndex;
+
+    bool operator>(const CoreReadyEntry& other) const {
+        return tie(key, sequence) > tie(other.key, other.sequence);
+    }
+};
+
+struct SimulatedCore {
+    priority_queue<CoreReadyEntry, vector<CoreReadyEntry>, greater<CoreReadyEntry>> readyQueue;
+    int running = -1; // Process on the CPU, -1 when idle
+    long long sliceStart = 0;
+    long long sliceEnd = 0;
+    bool contended = false; // Whether the running slice demotes a feedback process when it expires
+};
+
+// HRRN and Aging rank processes by how long they have waited on one shared queue,
+// which has no per-core counterpart, and the proportional-share policies share out one CPU,
+// so only the remaining policies can run on several CPUs
+inline bool supportsMultiCore(char algorithmId) {
+    return algorithmId >= '1' && algorithmId <= '7' && algorithmId != '5';
+}
+
+// Order of a process within its core's ready queue under the given policy
+inline long long coreReadyKey(char algorithmId, int serviceTime, int remainingTime, int level) {
+    switch (algorithmId)
+    {
+    case '3': return serviceTime;
+    case '4': return remainingTime;
+    case '6':
+    case '7': return level;
+    default: return 0; // FCFS and RR keep arrival order
+    }
+}
+
+/*
+ * Simulate coreCount CPUs running one policy.
+ * Each arrival joins the ready queue of the least loaded core (running plus
+ * waiting processes, lowest core first on ties). A core whose own queue runs
+ * dry steals the next process from the longest queue of another core. Within
+ * a core the policy behaves as on a single CPU: RR and the feedback policies
+ * requeue an unfinished process behind the arrivals of the same instant,
+ * feedback demotes it under the single-CPU rule (DemoteWhenContended) applied
+ * to that core's queue, and SRT preempts when a shorter process arrives at the core.
+ * Events are processed in time order, so the cost is proportional to the
+ * number of dispatches rather than to lastMoment times coreCount.
+ */
+inline void runMultiCore(SimulationContext& context, char algorithmId, int quantum, int coreCount) {
+    const Workload& workload = context.workload;
+    vector<SimulatedCore> cores(coreCount);
+    context.coreUsage.assign(coreCount, CoreUsage());
+    vector<int> remainingTime(workload.processCount), level(workload.processCount, 0), lastCore(workload.processCount, -1);
+    set<pair<long long, int>> sliceEnds; // End of the running slice and core, for every busy core
+    set<int> idleCores;
+    for (int core = 0; core < coreCount; ++core) idleCores.insert(core);
+    vector<int> wokenCores;              // Cores that were idle when a process joined their queue
+    long long waiting = 0;               // Processes waiting in all ready queues together
+    long long sequence = 0;
+    int currentIndex = 0;
+
+    auto enqueue = [&](int core, int processIndex) {
+        SimulatedCore& target = cores[core];
+        long long tieBreaker = (algorithmId == '1' || algorithmId == '2') ? sequence++ : processIndex;
+        target.readyQueue.push({coreReadyKey(algorithmId, workload.service[processIndex], remainingTime[processIndex], level[processIndex]), tieBreaker, processIndex});
+        countPush(context);
+        waiting++;
+        if (target.running == -1) wokenCores.push_back(core);
+    };
+
+    // Take the running process off a core at the given time and return it
+    auto stopRunning = [&](int core, long long time) {
+        SimulatedCore& source = cores[core];
+        int processIndex = source.running;
+        sliceEnds.erase({source.sliceEnd, core});
+        if (time > source.sliceStart) {
+            recordRun(context, processIndex, source.sliceStart, time, core);
+            remainingTime[processIndex] -= time - source.sliceStart;
+            context.coreUsage[core].busyTime += time - source.sliceStart;
+        }
+        source.running = -1;
+        idleCores.insert(core);
+        return processIndex;
+    };
+
+    auto dispatch = [&](int core, long long time) {
+        SimulatedCore& target = cores[core];
+        int processIndex = target.readyQueue.top().processIndex;
+        countPop(context, target.readyQueue.size());
+        target.readyQueue.pop();
+        waiting--;
+
+        long long untilArrival = nextArrivalTime(workload, currentIndex) - time;
+        target.contended = DemoteWhenContended::contended(!target.readyQueue.empty(), untilArrival);
+        long long slice = remainingTime[processIndex];
+        if (algorithmId == '2') slice = min<long long>(slice, quantum);
+        if (algorithmId == '6' || algorithmId == '7') {
+            // Only arrivals can join a running core's queue, so without competition the quanta
+            // up to the next arrival run back to back, as on a single CPU
+            long long levelQuantum = algorithmId == '6' ? 1 : 1LL << min(level[processIndex], 62);
+            slice = target.contended ? min(slice, levelQuantum) : loneSlice(levelQuantum, slice, untilArrival, workload.lastMoment - time);
+        }
+        slice = min(slice, workload.lastMoment - time);
+
+        if (lastCore[processIndex] != -1 && lastCore[processIndex] != core) context.migrations++;
+        lastCore[processIndex] = core;
+        context.coreUsage[core].dispatches++;
+        target.running = processIndex;
+        target.sliceStart = time;
+        target.sliceEnd = time + slice;
+        sliceEnds.insert({target.sliceEnd, core});
+        idleCores.erase(core);
+    };
+
+    vector<pair<int, int>> expired; // Core and process of slices that ended unfinished
+    while (true) {
+        long long nextArrival = nextArrivalTime(workload, currentIndex);
+        if (sliceEnds.empty() && (currentIndex == workload.processCount || nextArrival >= workload.lastMoment)) break;
+        long long time = sliceEnds.empty() ? nextArrival : min(nextArrival, sliceEnds.begin()->first);
+
+        expired.clear();
+        while (!sliceEnds.empty() && sliceEnds.begin()->first == time) {
+            int core = sliceEnds.begin()->second;
+            int processIndex = stopRunning(core, time);
+            if (remainingTime[processIndex] == 0) {
+                recordCompletion(context, processIndex, time);
+            } else {
+                expired.push_back({core, processIndex});
+            }
+            context.makespan = time;
+        }
+        if (time >= workload.lastMoment) break;
+
+        while (nextArrivalTime(workload, currentIndex) <= time) {
+            int processIndex = currentIndex++;
+            remainingTime[processIndex] = workload.service[processIndex];
+            int target = 0;
+            for (int core = 1; core < coreCount; ++core) {
+                size_t load = cores[core].readyQueue.size() + (cores[core].running != -1);
+                if (load < cores[target].readyQueue.size() + (cores[target].running != -1)) target = core;
+            }
+            enqueue(target, processIndex);
+
+            SimulatedCore& chosen = cores[target];
+            if (algorithmId == '4' && chosen.running != -1) {
+                pair<long long, int> arriving(remainingTime[processIndex], processIndex);
+                pair<long long, int> running(remainingTime[chosen.running] - (time - chosen.sliceStart), chosen.running);
+                if (arriving < running) enqueue(target, stopRunning(target, time));
+            }
+        }
+
+        for (const pair<int, int>& entry : expired) {
+            if (algorithmId == '6' || algorithmId == '7') {
+                level[entry.second] = DemoteWhenContended::nextLevel(level[entry.second], cores[entry.first].contended);
+            }
+            enqueue(entry.first, entry.second);
+        }
+
+        for (int core : wokenCores) {
+            if (cores[core].running == -1 && !cores[core].readyQueue.empty()) dispatch(core, time);
+        }
+        wokenCores.clear();
+
+        // Idle cores run their own queue first and otherwise steal the next process of the longest other queue
+        for (auto it = idleCores.begin(); waiting > 0 && it != idleCores.end();) {
+            int core = *it++;
+            if (!cores[core].readyQueue.empty()) {
+                dispatch(core, time);
+                continue;
+            }
+            int victim = -1;
+            for (int other = 0; other < coreCount; ++other) {
+                if (other == core || cores[other].readyQueue.empty()) continue;
+                if (victim == -1 || cores[other].readyQueue.size() > cores[victim].readyQueue.size()) victim = other;
+            }
+            if (victim == -1) continue;
+            CoreReadyEntry stolen = cores[victim].readyQueue.top();
+            cores[victim].readyQueue.pop();
+            cores[core].readyQueue.push(stolen);
+            context.coreUsage[core].steals++;
+            dispatch(core, time);
+        }
+    }
+}
+
+#endif // SCHEDULER_MULTICORE_H
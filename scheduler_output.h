@@ -0,0 +1,92 @@
+#ifndef SCHEDULER_OUTPUT_H
+#define SCHEDULER_OUTPUT_H
+
+#include <bits/stdc++.h>
+#include <unistd.h>
+
+using namespace std;
+
+/** Header for the buffered output writer used by the trace and statistics printers **/
+
+/*
+ * Formats text straight into one large reusable buffer and hands it to the
+ * file descriptor in big chunks whenever it fills up, instead of issuing a
+ * stream insertion (and possibly a flush) per timeline cell.
+ */
+class OutputBuffer {
+public:
+    explicit OutputBuffer(int fd, size_t capacity = 1 << 20) : fd(fd), buffer(capacity) {}
+
+    ~OutputBuffer() { flush(); }
+
+    void write(char c) {
+        *reserve(1) = c;
+        used++;
+    }
+
+    void write(string_view text) {
+        memcpy(reserve(text.size()), text.data(), text.size());
+        used += text.size();
+    }
+
+    // Append count copies of pattern, e.g. a run of "*|" timeline cells
+    void writeRepeated(string_view pattern, long long count) {
+        size_t perChunk = max<size_t>(1, buffer.size() / pattern.size());
+        while (count > 0) {
+            size_t copies = min<long long>(count, perChunk);
+            char* destination = reserve(copies * pattern.size());
+            for (size_t k = 0; k < copies; ++k) {
+                memcpy(destination + k * pattern.size(), pattern.data(), pattern.size());
+            }
+            used += copies * pattern.size();
+            count -= copies;
+        }
+    }
+
+    // Integer right-aligned to width, like printf("%*lld")
+    void writeInt(long long value, int width = 0) {
+        char digits[24];
+        int length = to_chars(digits, digits + sizeof(digits), value).ptr - digits;
+        writeRepeated(" ", width - length);
+        write(string_view(digits, length));
+    }
+
+    // Fixed-point number with the given number of decimals, like printf("%.*f")
+    void writeFixed(double value, int precision) {
+        char digits[64];
+        to_chars_result result = to_chars(digits, digits + sizeof(digits), value, chars_format::fixed, precision);
+        if (result.ec != errc()) {
+            result.ptr = digits + snprintf(digits, sizeof(digits), "%.*g", precision, value);
+        }
+        write(string_view(digits, result.ptr - digits));
+    }
+
+    void flush() {
+        size_t written = 0;
+        while (written < used) {
+            ssize_t count = ::write(fd, buffer.data() + written, used - written);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            written += count;
+        }
+        used = 0;
+    }
+
+private:
+    int fd;
+    vector<char> buffer;
+    size_t used = 0;
+
+    // Make room for size more bytes, flushing first if the buffer cannot hold them
+    char* reserve(size_t size) {
+        if (used + size > buffer.size()) {
+            flush();
+            if (size > buffer.size()) buffer.resize(size);
+        }
+        return buffer.data() + used;
+    }
+};
+
+#endif // SCHEDULER_OUTPUT_H
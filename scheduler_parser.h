@@ -2,27 +2,50 @@
 #define SCHEDULER_PARSER_H
 
 #include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
-/** Header for parsing and storing global scheduling variables **/
+/** Header for parsing the input into a workload **/
 
-// Operation modes and global variables
-string operationMode; // "trace" or "stats"
-int lastMoment;       // Last simulation time
-int processCount;     // Number of processes
+/*
+ * Everything a simulation reads: the parsed input, or a workload built directly
+ * by an embedding program. Processes must be ordered by arrival time.
+ * Runs only ever read a workload, so one instance can be shared by any number of threads.
+ */
+struct Workload {
+    string operationMode; // "trace" or "statistics"
+    int lastMoment = 0;   // Last simulation time
+    int processCount = 0; // Number of processes
+
+    vector<pair<char, int>> schedulingAlgorithms; // Algorithm ID ('0' + number) and quantum time (if applicable)
+
+    // Process table as parallel columns indexed by process number; the schedulers only touch arrival and service
+    vector<int> arrival;                // Arrival time
+    vector<int> service;                // For algorithms 1-7: service time; for 8: priority; for 9-11: weight
+    string names;                       // Every process name back to back, read only when printing
+    vector<uint32_t> nameOffsets = {0}; // Name i is names[nameOffsets[i], nameOffsets[i + 1])
 
-// Scheduling algorithms and process data
-vector<pair<char, int>> schedulingAlgorithms; // Algorithm ID and quantum time (if applicable)
-vector<tuple<string, int, int>> processList;  // For algorithms 1-7: process name, arrival time, service time
-                                             // For algorithm 8: process name, arrival time, priority
-vector<vector<char>> executionTimeline;      // Execution timeline for all processes
-unordered_map<string, int> processIndexMap;  // Map from process name to its index
+    string_view name(int processIndex) const {
+        return string_view(names).substr(nameOffsets[processIndex], nameOffsets[processIndex + 1] - nameOffsets[processIndex]);
+    }
+
+    void reserve(int count) {
+        arrival.reserve(count);
+        service.reserve(count);
+        nameOffsets.reserve(count + 1);
+    }
 
-// Results for each process
-vector<int> completionTime;
-vector<int> turnaroundTime;
-vector<float> normalizedTurnaround;
+    void addProcess(string_view processName, int arrivalTime, int serviceTime) {
+        arrival.push_back(arrivalTime);
+        service.push_back(serviceTime);
+        names.append(processName);
+        nameOffsets.push_back(names.size());
+    }
+};
 
 /*
  * Parse the scheduling algorithms from the input string.
@@ -30,7 +53,8 @@ vector<float> normalizedTurnaround;
  * For example: "2-4" means Round Robin with quantum=4.
  */
 
-void parseAlgorithms(const string& algorithmData) {
+inline vector<pair<char, int>> parseAlgorithms(const string& algorithmData) {
+    vector<pair<char, int>> schedulingAlgorithms;
     stringstream algorithmStream(algorithmData);  
 
     while (algorithmStream.good()) {  
@@ -41,7 +65,7 @@ void parseAlgorithms(const string& algorithmData) {
 
         string idPart, quantumPart;
         if (!getline(chunkStream, idPart, '-')) continue;  // Extract algorithm ID part
-        char algorithmId = idPart[0];  
+        char algorithmId = isdigit(static_cast<unsigned char>(idPart[0])) ? '0' + atoi(idPart.c_str()) : idPart[0];  // '0' + number
 
         int quantum = -1;  // Default value
         if (getline(chunkStream, quantumPart, '-') && !quantumPart.empty()) {
@@ -50,54 +74,245 @@ void parseAlgorithms(const string& algorithmData) {
 
         schedulingAlgorithms.push_back({algorithmId, quantum});  
     }
+    return schedulingAlgorithms;
+}
+
+
+/*
+ * Load the whole input without copying it where possible.
+ * A regular file (including a redirected stdin) is memory-mapped; pipes and
+ * terminals are read in large blocks into a buffer that lives for the whole run.
+ */
+inline string_view loadInput(int fd) {
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+            off_t offset = max<off_t>(0, lseek(fd, 0, SEEK_CUR));
+            return string_view(static_cast<const char*>(mapping) + offset, info.st_size - offset);
+        }
+    }
+
+    static string buffer;
+    vector<char> block(1 << 20);
+    ssize_t bytesRead;
+    while ((bytesRead = read(fd, block.data(), block.size())) > 0) {
+        buffer.append(block.data(), bytesRead);
+    }
+    return buffer;
 }
 
+/*
+ * Forward-only scanner over the loaded input.
+ * Tokens are views into the input and integers are converted in place with
+ * from_chars, so scanning allocates nothing per line.
+ */
+struct InputScanner {
+    const char* position;
+    const char* end;
+
+    explicit InputScanner(string_view text) : position(text.data()), end(text.data() + text.size()) {}
+
+    [[noreturn]] void fail(const char* expected) {
+        cerr << "Malformed input: expected " << expected << endl;
+        exit(1);
+    }
+
+    void skipWhitespace() {
+        while (position < end && isspace(static_cast<unsigned char>(*position))) ++position;
+    }
+
+    // Next run of characters up to whitespace or the delimiter
+    string_view nextField(char delimiter = ' ') {
+        const char* start = position;
+        while (position < end && *position != delimiter && !isspace(static_cast<unsigned char>(*position))) ++position;
+        return string_view(start, position - start);
+    }
+
+    string_view nextToken() {
+        skipWhitespace();
+        return nextField();
+    }
+
+    int nextInt() {
+        int value = 0;
+        auto [next, error] = from_chars(position, end, value);
+        if (error != errc()) fail("an integer");
+        position = next;
+        return value;
+    }
+
+    void expect(char c) {
+        if (position >= end || *position != c) fail("','");
+        ++position;
+    }
+};
 
-void parseProcesses()
+// Each process is one token: name,arrival,service (or name,arrival,priority for Aging)
+inline void parseProcesses(InputScanner& scanner, Workload& workload)
 {
-    string processChunk, processName;
-    int processArrivalTime, processServiceTime;
-    for(int i = 0; i < processCount; i++)
+    workload.reserve(workload.processCount);
+    for(int i = 0; i < workload.processCount; i++)
     {
-        cin >> processChunk;
+        scanner.skipWhitespace();
+        string_view processName = scanner.nextField(',');
+        scanner.expect(',');
+        int processArrivalTime = scanner.nextInt();
+        scanner.expect(',');
+        int processServiceTime = scanner.nextInt();
+        scanner.nextField(); // ignore anything trailing the last field
 
-        stringstream stream(processChunk);
-        string temp;
-        getline(stream, temp, ',');
-        processName = temp;
-        getline(stream, temp, ',');
-        processArrivalTime = stoi(temp);
-        getline(stream, temp, ',');
-        processServiceTime = stoi(temp);
+        workload.addProcess(processName, processArrivalTime, processServiceTime);
+    }
+}
+
+/*
+ * Binary workload format (version 1), produced by "--convert" from the text format.
+ * A fixed header is followed by 4-byte aligned sections:
+ *   operation mode and algorithm list, as written on lines 1-2 of the text format
+ *   arrival[processCount] and service[processCount] as int32 columns
+ *   nameOffsets[processCount + 1] (uint32) into the name table that follows
+ * The sections match the columns of Workload, so loading is one copy per column
+ * and nothing is tokenized.
+ */
+inline const char WORKLOAD_MAGIC[8] = {'C', 'P', 'U', 'S', 'C', 'H', 'E', 'D'};
+inline const uint32_t WORKLOAD_VERSION = 1;
+
+struct WorkloadFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t processCount;
+    int32_t lastMoment;
+    uint32_t modeLength;
+    uint32_t algorithmsLength;
+    uint32_t nameBytes;
+};
+
+inline size_t alignSection(size_t offset) {
+    return (offset + 3) & ~size_t(3);
+}
+
+inline bool isBinaryWorkload(string_view input) {
+    return input.size() >= sizeof(WorkloadFileHeader) && memcmp(input.data(), WORKLOAD_MAGIC, sizeof(WORKLOAD_MAGIC)) == 0;
+}
+
+[[noreturn]] inline void corruptWorkload() {
+    cerr << "Truncated/corrupt workload file" << endl;
+    exit(1);
+}
+
+// Every size in the header is checked against what is left of the input before it is used,
+// so a truncated or corrupt file cannot make the loader read past its end
+inline void parseBinaryWorkload(string_view input, Workload& workload) {
+    WorkloadFileHeader header;
+    memcpy(&header, input.data(), sizeof(header));
+    if (header.version != WORKLOAD_VERSION) {
+        cerr << "Unsupported workload format version " << header.version << endl;
+        exit(1);
+    }
+    if (header.processCount > (uint32_t)INT_MAX) corruptWorkload();
+
+    size_t offset = sizeof(header);
+    // Start of a section of the given size, which must fit in the rest of the input
+    auto section = [&](size_t bytes) {
+        if (offset > input.size() || bytes > input.size() - offset) corruptWorkload();
+        const char* start = input.data() + offset;
+        offset += bytes;
+        return start;
+    };
+    size_t processCount = header.processCount;
+
+    workload.operationMode.assign(section(header.modeLength), header.modeLength);
+    string algorithmData(section(header.algorithmsLength), header.algorithmsLength);
+    offset = alignSection(offset);
 
-        processList.push_back(make_tuple(processName, processArrivalTime, processServiceTime) );
-        processIndexMap[processName] = i;
+    const int32_t* arrival = reinterpret_cast<const int32_t*>(section(sizeof(int32_t) * processCount));
+    const int32_t* service = reinterpret_cast<const int32_t*>(section(sizeof(int32_t) * processCount));
+    const uint32_t* nameOffsets = reinterpret_cast<const uint32_t*>(section(sizeof(uint32_t) * (processCount + 1)));
+    const char* names = section(header.nameBytes);
+
+    // Names are consecutive slices of the name table
+    if (nameOffsets[0] != 0 || nameOffsets[processCount] > header.nameBytes) corruptWorkload();
+    for (size_t i = 0; i < processCount; ++i) {
+        if (nameOffsets[i] > nameOffsets[i + 1]) corruptWorkload();
+    }
+
+    workload.lastMoment = header.lastMoment;
+    workload.processCount = processCount;
+    workload.schedulingAlgorithms = parseAlgorithms(algorithmData);
+
+    workload.arrival.assign(arrival, arrival + workload.processCount);
+    workload.service.assign(service, service + workload.processCount);
+    workload.nameOffsets.assign(nameOffsets, nameOffsets + workload.processCount + 1);
+    workload.names.assign(names, header.nameBytes);
+}
+
+// Algorithm list in the text syntax, e.g. "1,2-4,8-1"
+inline string formatAlgorithms(const vector<pair<char, int>>& schedulingAlgorithms) {
+    string algorithmData;
+    for (const auto& algorithm : schedulingAlgorithms) {
+        if (!algorithmData.empty()) algorithmData += ',';
+        algorithmData += to_string(algorithm.first - '0');
+        if (algorithm.second != -1) algorithmData += "-" + to_string(algorithm.second);
+    }
+    return algorithmData;
+}
+
+// Write the parsed workload in the binary format
+inline void writeBinaryWorkload(const Workload& workload, const string& path) {
+    string algorithmData = formatAlgorithms(workload.schedulingAlgorithms);
+
+    WorkloadFileHeader header = {};
+    memcpy(header.magic, WORKLOAD_MAGIC, sizeof(WORKLOAD_MAGIC));
+    header.version = WORKLOAD_VERSION;
+    header.processCount = workload.processCount;
+    header.lastMoment = workload.lastMoment;
+    header.modeLength = workload.operationMode.size();
+    header.algorithmsLength = algorithmData.size();
+    header.nameBytes = workload.names.size();
+
+    ofstream file(path, ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file << workload.operationMode << algorithmData;
+    size_t textEnd = sizeof(header) + workload.operationMode.size() + algorithmData.size();
+    file.write("\0\0\0", alignSection(textEnd) - textEnd);
+    file.write(reinterpret_cast<const char*>(workload.arrival.data()), sizeof(int32_t) * workload.processCount);
+    file.write(reinterpret_cast<const char*>(workload.service.data()), sizeof(int32_t) * workload.processCount);
+    file.write(reinterpret_cast<const char*>(workload.nameOffsets.data()), sizeof(uint32_t) * (workload.processCount + 1));
+    file << workload.names;
+    if (!file) {
+        cerr << "Could not write workload file " << path << endl;
+        exit(1);
     }
 }
 
 /**
  * Parse the entire input based on the specified format.
+ * Binary workloads are recognised by their magic bytes; anything else is read as text.
  */
-void parseInputData() {
-    string algorithmData;
+inline Workload parseInputData() {
+    Workload workload;
+    string_view input = loadInput(STDIN_FILENO);
+    if (isBinaryWorkload(input)) {
+        parseBinaryWorkload(input, workload);
+        return workload;
+    }
+    InputScanner scanner(input);
 
     // Read operation mode, algorithm data, last simulation time, and process count
-    cin >> operationMode;
-    cin >> algorithmData;
-    cin >> lastMoment;
-    cin >> processCount;
+    workload.operationMode = string(scanner.nextToken());
+    string algorithmData(scanner.nextToken());
+    scanner.skipWhitespace();
+    workload.lastMoment = scanner.nextInt();
+    scanner.skipWhitespace();
+    workload.processCount = scanner.nextInt();
 
     // Parse algorithms and processes
-    parseAlgorithms(algorithmData);
-
-    parseProcesses();
-
-    // Initialize result vectors and timeline matrix
-    completionTime.resize(processCount);
-    turnaroundTime.resize(processCount);
-    normalizedTurnaround.resize(processCount);
+    workload.schedulingAlgorithms = parseAlgorithms(algorithmData);
 
-    executionTimeline.resize(lastMoment, vector<char>(processCount, ' '));
+    parseProcesses(scanner, workload);
+    return workload;
 }
 
 #endif // SCHEDULER_PARSER_H
@@ -0,0 +1,113 @@
+#ifndef SCHEDULER_PERCENTILES_H
+#define SCHEDULER_PERCENTILES_H
+
+#include <bits/stdc++.h>
+#include "scheduler_parser.h"
+#include "scheduler_algorithms.h"
+
+using namespace std;
+
+/** Header for the tail-latency percentiles of a run **/
+
+/*
+ * Log-linear histogram of non-negative integers in the style of HdrHistogram.
+ * Values below 256 get a bucket each; above that every power of two is split
+ * into 128 buckets, so a reported value is within 1% of the true one.
+ * The bucket array has a fixed size, however many values are recorded.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 7;
+    static const int BUCKET_COUNT = (65 - SUB_BUCKET_BITS) << SUB_BUCKET_BITS;
+
+    LatencyHistogram() : counts(BUCKET_COUNT, 0) {}
+
+    void record(uint64_t value) {
+        counts[bucketOf(value)]++;
+        total++;
+        largest = max(largest, value);
+    }
+
+    long long count() const { return total; }
+    uint64_t maximum() const { return largest; }
+
+    // Smallest value with at least fraction of the recorded values at or below it
+    uint64_t percentile(double fraction) const {
+        if (total == 0) return 0;
+        long long rank = max<long long>(1, (long long)ceil(fraction * total - 1e-9));
+        long long seen = 0;
+        for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+            seen += counts[bucket];
+            if (seen >= rank) return min(highestInBucket(bucket), largest);
+        }
+        return largest;
+    }
+
+private:
+    vector<long long> counts;
+    long long total = 0;
+    uint64_t largest = 0;
+
+    // Branch-free: the magnitude of the value picks the bucket group, its top bits the bucket
+    static int bucketOf(uint64_t value) {
+        int shift = 63 - __builtin_clzll(value | ((2ULL << SUB_BUCKET_BITS) - 1)) - SUB_BUCKET_BITS;
+        return (shift << SUB_BUCKET_BITS) + (int)(value >> shift);
+    }
+
+    static uint64_t highestInBucket(int bucket) {
+        int shift = max(0, (bucket >> SUB_BUCKET_BITS) - 1);
+        uint64_t top = bucket - (shift << SUB_BUCKET_BITS);
+        return ((top + 1) << shift) - 1;
+    }
+};
+
+/*
+ * Parse the percentiles to report, e.g. "50,90,99,99.9".
+ * Each must be above 0 and at most 100.
+ */
+inline vector<string> parsePercentiles(const string& specification) {
+    vector<string> percentiles;
+    stringstream percentileStream(specification);
+    string percentile;
+    while (getline(percentileStream, percentile, ',')) {
+        char* end = nullptr;
+        double value = strtod(percentile.c_str(), &end);
+        if (percentile.empty() || *end != '\0' || !(value > 0 && value <= 100)) {
+            cerr << "Invalid percentile \"" << percentile << "\", expected a number in (0, 100]" << endl;
+            exit(1);
+        }
+        percentiles.push_back(percentile);
+    }
+    return percentiles;
+}
+
+// Normalized turnaround is recorded in thousandths
+inline const int NORMALIZED_SCALE = 1000;
+
+struct LatencySummary {
+    LatencyHistogram turnaround;
+    LatencyHistogram waiting;              // Turnaround minus service time
+    LatencyHistogram normalizedTurnaround; // In thousandths
+    int unfinished = 0;                    // Processes still running at lastMoment, left out of the histograms
+};
+
+// Histograms of one finished run, built in a single pass over its per-process results.
+// Unfinished processes have no turnaround and are only counted, as in summarizeRun.
+inline unique_ptr<LatencySummary> summarizeLatency(const SimulationContext& context) {
+    auto summary = make_unique<LatencySummary>();
+    const Workload& workload = context.workload;
+    for (int i = 0; i < workload.processCount; ++i) {
+        if (context.completionTime[i] <= 0) {
+            summary->unfinished++;
+            continue;
+        }
+        long long turnaround = context.turnaroundTime[i];
+        long long service = workload.service[i];
+        summary->turnaround.record(max(0LL, turnaround));
+        summary->waiting.record(max(0LL, turnaround - service));
+        summary->normalizedTurnaround.record(service > 0 ? llround((double)NORMALIZED_SCALE * turnaround / service) : 0);
+    }
+    return summary;
+}
+
+#endif // SCHEDULER_PERCENTILES_H
@@ -0,0 +1,199 @@
+#ifndef SCHEDULER_SIMULATION_H
+#define SCHEDULER_SIMULATION_H
+
+#include <bits/stdc++.h>
+#include "scheduler_parser.h"
+#include "scheduler_algorithms.h"
+#include "scheduler_multicore.h"
+#include "scheduler_sweep.h"
+
+using namespace std;
+
+/** Header for embedding the simulator in another program, without any global state **/
+
+// Algorithm to run, numbered as in the input format, with its quantum (-1 if it takes none)
+struct AlgorithmSpec {
+    int id;
+    int quantum = -1; // Required by RR and Aging; CFS, stride and lottery default to 1
+    int cores = 1;
+    FeedbackConfig feedback; // Queue shape for FB-1 and FB-2i on one core
+    SwitchCostModel switchCost; // CPU time charged per process switch, on one core
+};
+
+// Outcome of one run, per process in workload order
+struct SimulationResult {
+    string algorithm; // Display name, e.g. "RR-4"
+    vector<int> completionTime;
+    vector<int> turnaroundTime;
+    vector<float> normalizedTurnaround;
+    vector<vector<RunSegment>> executionSegments; // Empty unless the timeline was requested
+    double meanTurnaround = 0;
+    double meanNormalizedTurnaround = 0;
+    vector<CoreUsage> coreUsage; // Empty for single-core runs
+    long long migrations = 0;
+    long long switches = 0;      // Switches charged by the switch cost model
+    long long lostTime = 0;      // CPU time they cost
+    double throughput = 0;       // Processes finished per time unit, up to the last completion
+};
+
+// Saved state of a run and the algorithm it belongs to, see Simulation::resume
+struct SimulationSnapshot {
+    AlgorithmSpec spec;
+    SchedulerSnapshot state;
+};
+
+/*
+ * A workload ready to be simulated with any number of algorithms.
+ * run() keeps all of its state in a context of its own and only reads the
+ * workload, so one Simulation can be used from many threads at once.
+ * Invalid workloads and specifications throw invalid_argument.
+ */
+class Simulation {
+public:
+    explicit Simulation(Workload workload) : workload(move(workload)) {
+        const Workload& w = this->workload;
+        if (w.processCount != (int)w.arrival.size() || w.processCount != (int)w.service.size() || w.processCount + 1 != (int)w.nameOffsets.size()) {
+            throw invalid_argument("processCount does not match the process table");
+        }
+        if (w.nameOffsets.back() != w.names.size()) throw invalid_argument("name offsets do not match the name table");
+        for (int i = 0; i < w.processCount; ++i) {
+            if (w.service[i] < 0) throw invalid_argument("negative service time");
+            if (i > 0 && w.arrival[i] < w.arrival[i - 1]) {
+                throw invalid_argument("processes are not ordered by arrival time");
+            }
+        }
+    }
+
+    const Workload& getWorkload() const { return workload; }
+
+    SimulationResult run(const AlgorithmSpec& spec, bool recordTimeline = false) const {
+        return execute(spec, recordTimeline, nullptr);
+    }
+
+    /*
+     * Run as above, also keeping a snapshot at the first scheduling point at or
+     * after each of snapshotTimes. After adding jobs to the tail of the workload
+     * or editing jobs that arrive later, resume() continues from the latest
+     * snapshot that still applies instead of simulating again from time 0.
+     */
+    SimulationResult run(const AlgorithmSpec& spec, bool recordTimeline, const vector<long long>& snapshotTimes, vector<SimulationSnapshot>& snapshots) const {
+        return runWithSnapshots(nullptr, spec, recordTimeline, snapshotTimes, snapshots);
+    }
+
+    // Latest of the snapshots this workload can continue from, null if none fits
+    const SimulationSnapshot* latestSnapshot(const vector<SimulationSnapshot>& snapshots) const {
+        vector<const SimulationSnapshot*> byAdmitted;
+        for (const SimulationSnapshot& snapshot : snapshots) byAdmitted.push_back(&snapshot);
+        sort(byAdmitted.begin(), byAdmitted.end(), [](const SimulationSnapshot* a, const SimulationSnapshot* b) {
+            return a->state.admitted < b->state.admitted;
+        });
+
+        // One fingerprint pass over the workload serves every snapshot
+        const SimulationSnapshot* latest = nullptr;
+        uint64_t fingerprint = FINGERPRINT_SEED;
+        int fingerprinted = 0;
+        for (const SimulationSnapshot* snapshot : byAdmitted) {
+            if (snapshot->state.admitted > workload.processCount) break;
+            fingerprint = extendFingerprint(fingerprint, workload, fingerprinted, snapshot->state.admitted);
+            fingerprinted = snapshot->state.admitted;
+            if (snapshotFits(snapshot->state, workload, fingerprint) && (!latest || snapshot->state.time > latest->state.time)) {
+                latest = snapshot;
+            }
+        }
+        return latest;
+    }
+
+    /*
+     * Continue the run a snapshot was taken from, over this workload, and take
+     * new snapshots at snapshotTimes. Throws invalid_argument if the snapshot
+     * does not fit this workload, or lacks the timeline recordTimeline asks for.
+     */
+    SimulationResult resume(const SimulationSnapshot& from, bool recordTimeline, const vector<long long>& snapshotTimes, vector<SimulationSnapshot>& snapshots) const {
+        const SchedulerSnapshot& state = from.state;
+        if (state.admitted > workload.processCount ||
+            !snapshotFits(state, workload, extendFingerprint(FINGERPRINT_SEED, workload, 0, state.admitted))) {
+            throw invalid_argument("snapshot does not fit the workload");
+        }
+        if (recordTimeline && (int)state.executionSegments.size() != state.admitted) throw invalid_argument("snapshot has no timeline");
+        return runWithSnapshots(&from, from.spec, recordTimeline, snapshotTimes, snapshots);
+    }
+
+    SimulationResult resume(const SimulationSnapshot& from, bool recordTimeline = false) const {
+        vector<SimulationSnapshot> unused;
+        return resume(from, recordTimeline, {}, unused);
+    }
+
+    // Run the algorithm list stored in the workload, in order, reusing the scheduler storage between runs
+    vector<SimulationResult> runAll(bool recordTimeline = false) const {
+        vector<SimulationResult> results;
+        SchedulerArena arena;
+        for (const pair<char, int>& algorithm : workload.schedulingAlgorithms) {
+            AlgorithmSpec spec;
+            spec.id = algorithm.first - '0';
+            spec.quantum = algorithm.second;
+            results.push_back(execute(spec, recordTimeline, nullptr, &arena));
+        }
+        return results;
+    }
+
+private:
+    Workload workload;
+
+    SimulationResult runWithSnapshots(const SimulationSnapshot* from, const AlgorithmSpec& spec, bool recordTimeline,
+                                      const vector<long long>& snapshotTimes, vector<SimulationSnapshot>& snapshots) const {
+        if (spec.cores != 1) throw invalid_argument("snapshots need a single-core run");
+        if (spec.id > 8) throw invalid_argument("snapshots need one of algorithms 1-8");
+        SnapshotPlan plan;
+        plan.times = snapshotTimes;
+        sort(plan.times.begin(), plan.times.end());
+        plan.resumeFrom = from ? &from->state : nullptr;
+
+        SimulationResult result = execute(spec, recordTimeline, &plan);
+        for (SchedulerSnapshot& state : plan.taken) snapshots.push_back({spec, move(state)});
+        return result;
+    }
+
+    SimulationResult execute(const AlgorithmSpec& spec, bool recordTimeline, SnapshotPlan* plan, SchedulerArena* arena = nullptr) const {
+        if (spec.id < 1 || spec.id > ALGORITHM_COUNT) throw invalid_argument("unknown algorithm " + to_string(spec.id));
+        char algorithmId = '0' + spec.id;
+        if (requiresQuantum(algorithmId) && spec.quantum < 1) throw invalid_argument("quantum must be positive");
+        if (spec.cores < 1 || (spec.cores > 1 && !supportsMultiCore(algorithmId))) throw invalid_argument("unsupported core count");
+        if (spec.feedback.levelCount < 0 || spec.feedback.boostPeriod < 0) throw invalid_argument("invalid feedback configuration");
+        for (long long quantum : spec.feedback.quanta) {
+            if (quantum < 1) throw invalid_argument("feedback quanta must be positive");
+        }
+        const SwitchCostModel& switchCost = spec.switchCost;
+        if (switchCost.switchCost < 0 || switchCost.warmupCost < 0 || switchCost.coldAfter < 0) throw invalid_argument("negative switch cost");
+        if (switchCost.enabled() && spec.cores > 1) throw invalid_argument("switch costs need a single-core run");
+        if (spec.feedback.customized() && spec.cores > 1) throw invalid_argument("feedback configurations need a single-core run");
+
+        SimulationContext context(workload, recordTimeline);
+        context.feedback = spec.feedback;
+        context.snapshots = plan;
+        context.arena = arena;
+        context.switchCosts.model = spec.switchCost;
+        if (spec.cores > 1) {
+            runMultiCore(context, algorithmId, spec.quantum, spec.cores);
+        } else {
+            executeSchedulingAlgorithm(context, algorithmId, spec.quantum);
+        }
+
+        SweepResult means = summarizeRun(context);
+        SimulationResult result;
+        result.algorithm = algorithmName({algorithmId, spec.quantum});
+        result.completionTime = move(context.completionTime);
+        result.turnaroundTime = move(context.turnaroundTime);
+        result.normalizedTurnaround = move(context.normalizedTurnaround);
+        result.executionSegments = move(context.executionSegments);
+        result.meanTurnaround = means.meanTurnaround;
+        result.meanNormalizedTurnaround = means.meanNormalizedTurnaround;
+        result.coreUsage = move(context.coreUsage);
+        result.migrations = context.migrations;
+        result.switches = context.switchCosts.switches;
+        result.lostTime = context.switchCosts.lostTime;
+        result.throughput = means.throughput;
+        return result;
+    }
+};
+
+#endif // SCHEDULER_SIMULATION_H
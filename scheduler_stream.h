@@ -0,0 +1,164 @@
+#ifndef SCHEDULER_STREAM_H
+#define SCHEDULER_STREAM_H
+
+#include <bits/stdc++.h>
+#include <unistd.h>
+#include "scheduler_algorithms.h"
+#include "scheduler_output.h"
+
+using namespace std;
+
+/** Header for simulating an unbounded stream of jobs with memory bounded by the active ones **/
+
+// A job between its arrival and its completion
+struct StreamedJob {
+    string name;
+    long long arrival;
+    int service;
+};
+
+/*
+ * Feed for the composed policies that reads jobs, one "name,arrival,service"
+ * line each and in arrival order, only when the simulation needs to know the
+ * next arrival. Each completion is written as a CSV record and the job is
+ * forgotten, so memory grows with the number of active jobs, not the trace.
+ * A job finishes as soon as the following job (or the end of input) has been
+ * read, because until then a new arrival could still change the schedule;
+ * pending records are flushed before every read that may block.
+ */
+class JobStreamFeed {
+public:
+    static constexpr long long NEVER = LLONG_MAX / 4;
+
+    JobStreamFeed(int fd, OutputBuffer& out) : fd(fd), out(out), buffer(1 << 16) {
+        out.write("Process,Arrival,Service,Finish,Turnaround,NormTurn\n");
+    }
+
+    long long horizon() const { return NEVER; }
+
+    long long nextArrival() {
+        readAhead();
+        return hasNext ? next.arrival : NEVER;
+    }
+
+    bool exhausted() {
+        readAhead();
+        return !hasNext;
+    }
+
+    ReadyProcess admit() {
+        readAhead();
+        if (jobCount == INT_MAX) fail("more jobs than a stream can number");
+        int processIndex = jobCount++;
+        int service = next.service;
+        activeJobs.emplace(processIndex, move(next));
+        hasNext = false;
+        return {processIndex, service, service, 0};
+    }
+
+    void queued() {}
+    void selected(long long) {}
+    void ran(int, long long, long long) {}
+
+    // Switching is free and a stream is never replayed, so it takes no snapshots
+    long long dispatchOverhead(int, long long) { return 0; }
+    bool wantsSnapshot(long long) const { return false; }
+    template <class ReadyQueue> void snapshot(long long, const ReadyQueue&) {}
+    template <class ReadyQueue> void resume(long long&, ReadyQueue&) {}
+
+    void completed(int processIndex, long long finishTime) {
+        auto job = activeJobs.find(processIndex);
+        long long turnaround = finishTime - job->second.arrival;
+        out.write(job->second.name);
+        out.write(',');
+        out.writeInt(job->second.arrival);
+        out.write(',');
+        out.writeInt(job->second.service);
+        out.write(',');
+        out.writeInt(finishTime);
+        out.write(',');
+        out.writeInt(turnaround);
+        out.write(',');
+        out.writeFixed(1.0 * turnaround / job->second.service, 2);
+        out.write('\n');
+        activeJobs.erase(job);
+    }
+
+private:
+    int fd;
+    OutputBuffer& out;
+    vector<char> buffer;
+    size_t begin = 0, end = 0;
+    bool endOfInput = false;
+    long long lineNumber = 0;
+
+    bool hasNext = false;
+    StreamedJob next;
+    long long lastArrival = 0;
+    int jobCount = 0;
+    unordered_map<int, StreamedJob> activeJobs; // By process index
+
+    [[noreturn]] void fail(const string& problem) {
+        out.flush();
+        cerr << "Job stream line " << lineNumber << ": " << problem << endl;
+        exit(1);
+    }
+
+    // Next input line without its terminator; false at the end of input
+    bool readLine(string& line) {
+        line.clear();
+        while (true) {
+            char* newline = static_cast<char*>(memchr(buffer.data() + begin, '\n', end - begin));
+            if (newline) {
+                line.append(buffer.data() + begin, newline);
+                begin = newline - buffer.data() + 1;
+                return true;
+            }
+            line.append(buffer.data() + begin, buffer.data() + end);
+            begin = end = 0;
+            if (endOfInput) return !line.empty();
+
+            out.flush(); // Completed jobs become visible before waiting for more input
+            ssize_t bytesRead;
+            do {
+                bytesRead = read(fd, buffer.data(), buffer.size());
+            } while (bytesRead < 0 && errno == EINTR);
+            if (bytesRead <= 0) endOfInput = true;
+            else end = bytesRead;
+        }
+    }
+
+    void readAhead() {
+        string line;
+        while (!hasNext && readLine(line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+
+            size_t firstComma = line.find(',');
+            size_t secondComma = firstComma == string::npos ? string::npos : line.find(',', firstComma + 1);
+            if (secondComma == string::npos) fail("expected name,arrival,service");
+            const char* lineEnd = line.data() + line.size();
+            long long arrival;
+            int service;
+            from_chars_result parsed = from_chars(line.data() + firstComma + 1, line.data() + secondComma, arrival);
+            if (parsed.ec != errc() || parsed.ptr != line.data() + secondComma) fail("invalid arrival time");
+            parsed = from_chars(line.data() + secondComma + 1, lineEnd, service);
+            if (parsed.ec != errc() || service <= 0) fail("invalid service time");
+            if (arrival < lastArrival || arrival >= NEVER) fail("jobs must be in arrival order");
+
+            lastArrival = arrival;
+            next = {line.substr(0, firstComma), arrival, service};
+            hasNext = true;
+        }
+    }
+};
+
+// Simulate the jobs read from fd with one of the composed policies, writing completions to out
+inline void runStream(char algorithmId, int quantum, int fd, OutputBuffer& out, const FeedbackConfig& feedback = FeedbackConfig()) {
+    JobStreamFeed feed(fd, out);
+    SchedulerArena arena; // The number of jobs is unknown, so the buffers grow as needed
+    runComposedAlgorithm(feed, algorithmId, quantum, feedback, arena);
+}
+
+#endif // SCHEDULER_STREAM_H
@@ -0,0 +1,101 @@
+#ifndef SCHEDULER_SWEEP_H
+#define SCHEDULER_SWEEP_H
+
+#include <bits/stdc++.h>
+#include "scheduler_parser.h"
+#include "scheduler_algorithms.h"
+
+using namespace std;
+
+/** Header for parameter sweeps over algorithms and quanta **/
+
+// Means of one sweep configuration over the processes that finished, and what switching
+// cost the run under a switch cost model
+struct SweepResult {
+    double meanTurnaround = 0;
+    double meanNormalizedTurnaround = 0;
+    long long lostTime = 0;
+    double throughput = 0; // Processes finished per time unit, up to the last completion
+    int unfinished = 0;    // Processes still running at lastMoment
+};
+
+[[noreturn]] inline void invalidSweep(const string& entry) {
+    cerr << "Invalid sweep entry \"" << entry << "\", expected <algorithm>[-<quantum>[..<last>[:<step>]]]" << endl;
+    exit(1);
+}
+
+/*
+ * Expand a sweep specification into algorithm configurations.
+ * Entries are separated by commas; each is an algorithm ID, optionally with
+ * a quantum or an inclusive range of quanta and a step.
+ * For example: "1,2-1..500,8-1..64:2" is FCFS, RR with quantum 1 to 500,
+ * and Aging with quantum 1, 3, ..., 63.
+ */
+inline vector<pair<char, int>> parseSweep(const string& specification) {
+    vector<pair<char, int>> configurations;
+    stringstream specificationStream(specification);
+    string entry;
+    while (getline(specificationStream, entry, ',')) {
+        int number = 0;
+        const char* end = entry.data() + entry.size();
+        from_chars_result parsed = from_chars(entry.data(), end, number);
+        if (parsed.ec != errc() || number < 1 || number > ALGORITHM_COUNT) invalidSweep(entry);
+        char algorithmId = '0' + number;
+        if (parsed.ptr == end) {
+            if (requiresQuantum(algorithmId)) invalidSweep(entry);
+            configurations.push_back({algorithmId, -1});
+            continue;
+        }
+        if (*parsed.ptr != '-') invalidSweep(entry);
+
+        int first = 0, last = 0, step = 1;
+        parsed = from_chars(parsed.ptr + 1, end, first);
+        if (parsed.ec != errc()) invalidSweep(entry);
+        last = first;
+        if (parsed.ptr != end) {
+            if (end - parsed.ptr < 3 || parsed.ptr[0] != '.' || parsed.ptr[1] != '.') invalidSweep(entry);
+            parsed = from_chars(parsed.ptr + 2, end, last);
+            if (parsed.ec != errc()) invalidSweep(entry);
+            if (parsed.ptr != end) {
+                if (*parsed.ptr != ':') invalidSweep(entry);
+                parsed = from_chars(parsed.ptr + 1, end, step);
+                if (parsed.ec != errc() || parsed.ptr != end) invalidSweep(entry);
+            }
+        }
+        if (first < 1 || last < first || step < 1) invalidSweep(entry);
+
+        for (long long quantum = first; quantum <= last; quantum += step) {
+            configurations.push_back({algorithmId, (int)quantum});
+        }
+    }
+    if (configurations.empty()) invalidSweep(specification);
+    return configurations;
+}
+
+inline SweepResult summarizeRun(const SimulationContext& context) {
+    SweepResult result;
+    int processCount = context.workload.processCount;
+    if (processCount == 0) return result;
+    // Unfinished processes have no turnaround; counting them as 0 would flatter the run
+    long long turnaroundSum = 0;
+    double normalizedSum = 0;
+    int finished = 0;
+    int lastCompletion = 0;
+    for (int i = 0; i < processCount; ++i) {
+        if (context.completionTime[i] <= 0) continue;
+        turnaroundSum += context.turnaroundTime[i];
+        normalizedSum += context.normalizedTurnaround[i];
+        ++finished;
+        lastCompletion = max(lastCompletion, context.completionTime[i]);
+    }
+    if (finished > 0) {
+        result.meanTurnaround = 1.0 * turnaroundSum / finished;
+        result.meanNormalizedTurnaround = normalizedSum / finished;
+    }
+    result.lostTime = context.switchCosts.lostTime;
+    result.throughput = lastCompletion > 0 ? 1.0 * finished / lastCompletion : 0;
+    result.unfinished = processCount - finished;
+    return result;
+}
+
+#endif // SCHEDULER_SWEEP_H
@@ -0,0 +1,78 @@
+#ifndef WORKLOAD_GENERATOR_H
+#define WORKLOAD_GENERATOR_H
+
+#include <bits/stdc++.h>
+#include "scheduler_parser.h"
+
+using namespace std;
+
+/** Header for generating seeded synthetic workloads **/
+
+/*
+ * Shape of a synthetic workload.
+ * Arrivals are either Poisson or bursty (batches of processes arriving together,
+ * with the same long-run rate). Service times are exponential or heavy-tailed
+ * Pareto. The mean interarrival time is chosen so that the offered load,
+ * meanService / meanInterarrival, equals loadFactor.
+ */
+struct WorkloadShape {
+    string arrivals = "poisson";    // "poisson" or "bursty"
+    string service = "exponential"; // "exponential" or "pareto"
+    double meanService = 10.0;
+    double loadFactor = 0.9;
+    double meanBurstSize = 10.0;    // Mean number of processes per batch for bursty arrivals
+    double paretoShape = 1.5;       // Tail index of Pareto service times, must be above 1
+};
+
+inline const int MAX_GENERATED_SERVICE = 10000000;
+
+inline int sampleServiceTime(const WorkloadShape& shape, mt19937_64& random) {
+    double service;
+    if (shape.service == "pareto") {
+        // Scale chosen so that the distribution mean is meanService
+        double scale = shape.meanService * (shape.paretoShape - 1) / shape.paretoShape;
+        double uniform = 1.0 - uniform_real_distribution<double>(0.0, 1.0)(random);
+        service = scale / pow(uniform, 1.0 / shape.paretoShape);
+    } else {
+        service = exponential_distribution<double>(1.0 / shape.meanService)(random);
+    }
+    return (int)clamp<double>(llround(service), 1, MAX_GENERATED_SERVICE);
+}
+
+/*
+ * Generate a workload of count processes named P0, P1, ...
+ * The same shape and seed always produce the same workload. lastMoment is set
+ * to the last arrival plus the total service time, so every policy can finish.
+ */
+inline Workload generateWorkload(int count, const WorkloadShape& shape, uint64_t seed) {
+    Workload workload;
+    mt19937_64 random(seed);
+    double meanInterarrival = shape.meanService / shape.loadFactor;
+    bool bursty = shape.arrivals == "bursty";
+    exponential_distribution<double> gap(1.0 / (bursty ? meanInterarrival * shape.meanBurstSize : meanInterarrival));
+    geometric_distribution<int> extraInBurst(1.0 / shape.meanBurstSize);
+
+    workload.processCount = count;
+    workload.reserve(count);
+
+    double clock = 0;
+    long long totalService = 0;
+    int leftInBurst = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!bursty) {
+            if (i > 0) clock += gap(random);
+        } else if (leftInBurst-- == 0) {
+            if (i > 0) clock += gap(random);
+            leftInBurst = extraInBurst(random);
+        }
+        int service = sampleServiceTime(shape, random);
+        totalService += service;
+        workload.addProcess("P" + to_string(i), (int)clock, service);
+    }
+
+    long long horizon = (long long)clock + totalService;
+    workload.lastMoment = (int)min<long long>(horizon, INT_MAX - 1);
+    return workload;
+}
+
+#endif // WORKLOAD_GENERATOR_H